@@ -4,6 +4,9 @@
 #cmakedefine HAVE_UNISTD_H 1
 #cmakedefine HAVE_GETOPT_F 1
 #cmakedefine HAVE_GETLINE_F 1
+#cmakedefine HAVE_DIRENT_H 1
+#cmakedefine HAVE_UTIME 1
+#cmakedefine HAVE_MKSTEMP 1
 #cmakedefine HAVE_IO_H 1
 #cmakedefine HAVE_SETMODE 1
 #cmakedefine HAVE__SETMODE 1
@@ -13,6 +16,15 @@
 #cmakedefine HAVE__STRICMP_F 1
 #cmakedefine HAVE__STRNICMP_F 1
 #cmakedefine HAVE__MAX_PATH 1
+#cmakedefine HAVE__FINDFIRST 1
+#cmakedefine HAVE_COPY_FILE_RANGE 1
+#cmakedefine HAVE_SENDFILE 1
+#cmakedefine HAVE_FORK 1
+#cmakedefine HAVE_FLOCK 1
+#cmakedefine HAVE_INOTIFY 1
+#cmakedefine HAVE_CLOCK_GETTIME 1
+#cmakedefine HAVE_GETRUSAGE 1
+#cmakedefine HAVE_POSIX_FADVISE 1
 
 #ifndef HAVE__SETMODE
 #ifdef HAVE_SETMODE
@@ -28,6 +40,10 @@
 #endif /* HAVE_FILENO */
 #endif /* HAVE__FILENO */
 
+#ifndef HAVE__FILENO
+#define _fileno fileno
+#endif /* HAVE__FILENO */
+
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
@@ -0,0 +1,3 @@
+@ECHO OFF
+LIFUTILS LIFJOURNAL %*
+EXIT /B %ERRORLEVEL%
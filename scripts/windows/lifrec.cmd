@@ -0,0 +1,3 @@
+@ECHO OFF
+LIFUTILS LIFREC %*
+EXIT /B %ERRORLEVEL%
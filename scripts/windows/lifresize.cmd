@@ -0,0 +1,3 @@
+@ECHO OFF
+LIFUTILS LIFRESIZE %*
+EXIT /B %ERRORLEVEL%
@@ -0,0 +1,3 @@
+@ECHO OFF
+LIFUTILS LIFTRACE %*
+EXIT /B %ERRORLEVEL%
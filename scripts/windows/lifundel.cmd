@@ -0,0 +1,3 @@
+@ECHO OFF
+LIFUTILS LIFUNDEL %*
+EXIT /B %ERRORLEVEL%
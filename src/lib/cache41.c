@@ -0,0 +1,287 @@
+/* cache41.c -- cache of compiled HP41 programs */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* comp41 stores the compiled programs in a cache directory. The name of
+   an entry is the 64 bit hash of everything that determines the result of
+   a compilation (see comp41_compile_cached) as 16 hex digits with the
+   extension .c41. An entry consists of
+
+   "C41" CACHE41_VERSION   magic number and version
+   2 bytes                 length of the program, big endian
+   n bytes                 program
+   remaining bytes         messages of the compilation
+
+   An entry is written to a temporary file with a unique name first and
+   then renamed, thus parallel compilations of the same program never
+   write the same file or read an incomplete entry. The modification
+   time of an entry is updated on every hit, cache41_prune removes the
+   entries that were not used for some time.
+
+   Increment CACHE41_VERSION if the byte code generated by comp41 changes,
+   the old entries are not used then. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "config.h"
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_UTIME
+#include <utime.h>
+#endif
+#ifdef HAVE__FINDFIRST
+#include <io.h>
+#endif
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#endif
+#include "lifutils.h"
+#include "cache41.h"
+
+#define DEBUG 0
+
+#define CACHE41_VERSION 1
+#define KEY_LEN 16
+#define HEADER_SIZE 6
+
+unsigned long long cache41_hash(unsigned long long hash, const void *data, size_t length)
+  {
+    const unsigned char *p= (const unsigned char *) data;
+
+    while(length--)
+      {
+        hash= (hash ^ *p++) * 1099511628211ULL;
+      }
+    return(hash);
+  }
+
+unsigned long long cache41_hash_string(unsigned long long hash, const char *str)
+  {
+    return(cache41_hash(hash,str,strlen(str)+1));
+  }
+
+static char *cache41_path(char *dir, unsigned long long key, char *ext)
+  {
+    char *path;
+
+    path=malloc(strlen(dir)+KEY_LEN+strlen(ext)+2);
+    if(path == (char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    sprintf(path,"%s/%016llx%s",dir,key,ext);
+    return(path);
+  }
+
+int cache41_get(char *dir, unsigned long long key, unsigned char *code, int *length, FILE *msg)
+  {
+    FILE *fp;
+    char *path;
+    unsigned char header[HEADER_SIZE];
+    char buffer[4096];
+    size_t n;
+    int len;
+
+    path=cache41_path(dir,key,".c41");
+    fp=fopen(path,"rb");
+    if(fp == (FILE *) NULL)
+      {
+        debug_print("cache miss %s\n",path);
+        free(path);
+        return(0);
+      }
+    len= -1;
+    if(fread(header,1,HEADER_SIZE,fp) == HEADER_SIZE && memcmp(header,"C41",3) == 0 &&
+       header[3] == CACHE41_VERSION)
+      {
+        len=(header[4] << 8) | header[5];
+        if(len > MEMORY_SIZE || fread(code,1,len,fp) != (size_t) len) len= -1;
+      }
+    if(len == -1)
+      {
+        debug_print("invalid cache entry %s\n",path);
+        fclose(fp);
+        free(path);
+        return(0);
+      }
+    *length=len;
+    while((n=fread(buffer,1,sizeof(buffer),fp)) > 0) fwrite(buffer,1,n,msg);
+    fclose(fp);
+#ifdef HAVE_UTIME
+    /* the entry was used now */
+    utime(path,(struct utimbuf *) NULL);
+#endif
+    debug_print("cache hit %s\n",path);
+    free(path);
+    return(1);
+  }
+
+void cache41_put(char *dir, unsigned long long key, unsigned char *code, int length, FILE *messages)
+  {
+    FILE *fp;
+    char *path, *tmp_path;
+    unsigned char header[HEADER_SIZE];
+    char buffer[4096];
+    size_t n;
+    int err;
+#ifdef HAVE_MKSTEMP
+    int fd;
+#else
+    char ext[32];
+#endif
+
+    /* a unique temporary file, parallel compilations of the same program
+       must not write to the same file */
+#ifdef HAVE_MKSTEMP
+    tmp_path=cache41_path(dir,key,".tmp.XXXXXX");
+    fd=mkstemp(tmp_path);
+    fp= fd == -1 ? (FILE *) NULL : fdopen(fd,"wb");
+    if(fp == (FILE *) NULL && fd != -1)
+      {
+        close(fd);
+        remove(tmp_path);
+      }
+#else
+    sprintf(ext,".tmp.%d",(int) getpid());
+    tmp_path=cache41_path(dir,key,ext);
+    fp=fopen(tmp_path,"wb");
+#endif
+    if(fp == (FILE *) NULL)
+      {
+        fprintf(stderr,"Warning: cannot create cache entry %s\n",tmp_path);
+        free(tmp_path);
+        return;
+      }
+    memcpy(header,"C41",3);
+    header[3]=CACHE41_VERSION;
+    header[4]=length >> 8;
+    header[5]=length & 0xff;
+    err= fwrite(header,1,HEADER_SIZE,fp) != HEADER_SIZE;
+    err|= fwrite(code,1,length,fp) != (size_t) length;
+    rewind(messages);
+    while((n=fread(buffer,1,sizeof(buffer),messages)) > 0)
+      {
+        err|= fwrite(buffer,1,n,fp) != n;
+      }
+    err|= fclose(fp) != 0;
+
+    path=cache41_path(dir,key,".c41");
+    if(! err && rename(tmp_path,path) != 0)
+      {
+        /* rename does not replace an existing file on all systems */
+        remove(path);
+        err= rename(tmp_path,path) != 0;
+      }
+    if(err)
+      {
+        fprintf(stderr,"Warning: cannot create cache entry %s\n",path);
+        remove(tmp_path);
+      }
+    free(path);
+    free(tmp_path);
+  }
+
+#if defined(HAVE_DIRENT_H) || defined(HAVE__FINDFIRST)
+static int cache41_is_entry(char *name)
+  {
+    /* entry or temporary file of an entry */
+    int i;
+
+    for(i=0; i< KEY_LEN; i++)
+      {
+        if(name[i] == '\0' || strchr("0123456789abcdef",name[i]) == (char *) NULL) return(0);
+      }
+    return(strcmp(name+KEY_LEN,".c41") == 0 || strncmp(name+KEY_LEN,".tmp.",5) == 0);
+  }
+
+static int cache41_prune_entry(char *dir, char *name, time_t now, int days)
+  {
+    /* remove an entry that is too old, return 1 if it was removed */
+    struct stat st;
+    char *path;
+    int ret;
+
+    if(! cache41_is_entry(name)) return(0);
+    path=malloc(strlen(dir)+strlen(name)+2);
+    if(path == (char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    sprintf(path,"%s/%s",dir,name);
+    ret=0;
+    if(stat(path,&st) == 0 && (days == 0 || difftime(now,st.st_mtime) >= days*86400.0))
+      {
+        debug_print("remove %s\n",path);
+        ret= remove(path) == 0;
+      }
+    free(path);
+    return(ret);
+  }
+#endif
+
+int cache41_prune(char *dir, int days)
+  {
+#ifdef HAVE_DIRENT_H
+    DIR *d;
+    struct dirent *ent;
+    time_t now;
+    int count;
+
+    d=opendir(dir);
+    if(d == (DIR *) NULL)
+      {
+        fprintf(stderr,"Cannot open cache directory %s\n",dir);
+        return(-1);
+      }
+    now=time((time_t *) NULL);
+    count=0;
+    while((ent=readdir(d)) != (struct dirent *) NULL)
+      {
+        count+=cache41_prune_entry(dir,ent->d_name,now,days);
+      }
+    closedir(d);
+    return(count);
+#elif defined(HAVE__FINDFIRST)
+    struct _finddata_t fd;
+    intptr_t handle;
+    char *pattern;
+    time_t now;
+    int count;
+
+    pattern=malloc(strlen(dir)+3);
+    if(pattern == (char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    sprintf(pattern,"%s/*",dir);
+    handle=_findfirst(pattern,&fd);
+    free(pattern);
+    if(handle == -1)
+      {
+        fprintf(stderr,"Cannot open cache directory %s\n",dir);
+        return(-1);
+      }
+    now=time((time_t *) NULL);
+    count=0;
+    do
+      {
+        count+=cache41_prune_entry(dir,fd.name,now,days);
+      }
+    while(_findnext(handle,&fd) == 0);
+    _findclose(handle);
+    return(count);
+#else
+    (void) dir;
+    (void) days;
+    fprintf(stderr,"Pruning the cache is not supported on this system\n");
+    return(-1);
+#endif
+  }
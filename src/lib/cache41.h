@@ -0,0 +1,27 @@
+/* cache41.h -- cache of compiled HP41 programs */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#include <stdio.h>
+
+#define CACHE41_HASH_INIT 14695981039346656037ULL
+
+unsigned long long cache41_hash(unsigned long long hash, const void *data, size_t length);
+/* Continue the 64 bit FNV-1a hash with length bytes of data */
+
+unsigned long long cache41_hash_string(unsigned long long hash, const char *str);
+/* Continue the hash with the string including the terminating zero, thus
+   consecutive strings are separated */
+
+int cache41_get(char *dir, unsigned long long key, unsigned char *code, int *length, FILE *msg);
+/* Look up the entry key in the cache directory dir. On a hit, copy the
+   program to code, its length to length and the stored messages to msg
+   and return 1, otherwise return 0 */
+
+void cache41_put(char *dir, unsigned long long key, unsigned char *code, int length, FILE *messages);
+/* Store the program code with length bytes and the contents of the
+   temporary file messages as entry key. Errors are ignored, the entry is
+   not created then */
+
+int cache41_prune(char *dir, int days);
+/* Remove the entries that have not been used for the number of days, all
+   entries if days is 0. Return the number of removed entries or -1 */
@@ -31,6 +31,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "lif_dir_utils.h"
 #include "lif_const.h"
 #include "xrom.h"
+#include "lif_block.h"
+#include "jump41.h"
+#include "opt41.h"
+#include "cache41.h"
+#ifdef HAVE_FORK
+#include <sys/wait.h>
+#endif
 
 #define DEBUG (0)
 
@@ -42,120 +49,772 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #endif
 
 
-#define MAX_ARGS 5
 #define MAX_CODE 1500
 #define MAX_LINE 1500
 #define LINE_LEN 132
 
-/* global flags */
-struct globals {
-   int global_label ;
-   int global_count ;
-   int global_end  ;
+/* state and options of the compilation of one source file. Every source
+   file is compiled in its own unit, thus several files can be compiled
+   by one process or by parallel processes (see comp41_image) */
+struct comp41_unit {
+   // options
    int line_numbers;
    int force_global;
    int source_listing ;
    int code_listing;
-   int create_lif;
+   int optimize;                     // run the optimizer, see opt41.c
+   char *source_name;                // source file in messages or NULL
+   char *cache_dir;                  // cache directory or NULL, see cache41.c
+   FILE *msg;                        // stream of listings and messages
+   // state of the compilation
+   int global_label ;
+   int global_count ;
+   int global_end  ;
    char err_msg[LINE_LEN];
    char *source_line ;
    int errflag  ;
    int source_line_counter;
-} globals ;
-
-struct globals comp41glo ;
-
-
-void comp41_print_error(char * message)
+   int numeric_entry;                // last line was a number
+   int error_column;                 // column of the error in the source line
+   int token_column[ MAX_ARGS ];     // columns of the tokens of the line
+   int saved[ OPT41_RULES ];         // bytes saved by the optimizer rules
+   LEXER lexer;
+   unsigned char code_buffer[ MAX_CODE ];  // byte code of a line
+   unsigned char memory[ MEMORY_SIZE ];    // compiled program
+   int byte_counter;
+};
+
+// compiled program of comp41 -o
+struct comp41_program {
+   char *source;                     // source file
+   char name[ NAME_LEN+1 ];          // LIF file name
+   int status;
+   int byte_counter;
+   unsigned char *code;              // byte_counter bytes
+};
+
+
+void comp41_print_error(COMP41_UNIT *unit, char * message)
 {
-   if(! comp41glo.code_listing) {
-      fprintf(stderr,"%s\n",comp41glo.source_line);
+   int i;
+
+   if(! unit->code_listing) {
+      fprintf(unit->msg,"%s\n",unit->source_line);
+      // mark the column, keep the tabs of the source line
+      for( i = 0; i < unit->error_column - 1 && unit->source_line[ i ]; ++i )
+         fputc( unit->source_line[ i ] == '\t' ? '\t' : ' ', unit->msg );
+      fprintf(unit->msg,"^\n");
    }
-   fprintf(stderr,"Error at line %d: %s\n",comp41glo.source_line_counter,message);
-   comp41glo.errflag=1;
+   if(unit->source_name != (char *) NULL) fprintf(unit->msg,"%s: ",unit->source_name);
+   fprintf(unit->msg,"Error at line %d, column %d: %s\n",unit->source_line_counter,
+           unit->error_column,message);
+   unit->errflag=1;
 }
 
 
 void comp41_usage(void)
   {
-    fprintf(stderr,"Usage: lifutils comp41 [-l] [-g] [s] [-h] [-f LIFFILENAME] [-x XROMFILE][-x...] INPUTFILE > output file\n");
+    fprintf(stderr,"Usage: lifutils comp41 [-l] [-g] [s] [-h] [-O] [-c CACHEDIR] [-f LIFFILENAME] [-x XROMFILE][-x...] INPUTFILE > output file\n");
+    fprintf(stderr,"       or\n");
+    fprintf(stderr,"       lifutils comp41 [-l] [-g] [s] [-h] [-O] [-c CACHEDIR] [-f LIFFILENAME] [-x XROMFILE][-x...] < input file > output file\n");
     fprintf(stderr,"       or\n");
-    fprintf(stderr,"       lifutils comp41 [-l] [-g] [s] [-h] [-f LIFFILENAME] [-x XROMFILE][-x...] < input file > output file\n");
+    fprintf(stderr,"       lifutils comp41 [-l] [-g] [s] [-h] [-O] [-c CACHEDIR] [-j JOBS] [-x XROMFILE][-x...] -o LIFIMAGEFILE INPUTFILE [INPUTFILE ...]\n");
+    fprintf(stderr,"       or\n");
+    fprintf(stderr,"       lifutils comp41 -c CACHEDIR -P DAYS\n");
     fprintf(stderr,"       Compile a HP-41 FOCAL program\n");
     fprintf(stderr,"       -l skip line numbers\n");
     fprintf(stderr,"       -g force global for [ \"A..J\", \"a..e\" ] with quotes: [ lbl \"A\" ]\n");
     fprintf(stderr,"       -s output source listing on standard error\n");
     fprintf(stderr,"       -h output compiled byte code, requires -s\n");
+    fprintf(stderr,"       -O optimize the size of the compiled program and output the bytes saved\n");
+    fprintf(stderr,"          by each rule on standard error\n");
     fprintf(stderr,"       -f create a LIF file instead of a raw file. Requires parameter value LIFFILENAME\n");
+    fprintf(stderr,"       -o compile all input files and put them into the LIF image file LIFIMAGEFILE.\n");
+    fprintf(stderr,"          The LIF file name is the name of the input file without extension in\n");
+    fprintf(stderr,"          upper case.\n");
+    fprintf(stderr,"       -c CACHEDIR store the compiled programs in the directory CACHEDIR and use them\n");
+    fprintf(stderr,"          again if the source, the options and the XROM files are unchanged.\n");
+    fprintf(stderr,"          The default is the value of the environment variable LIFUTILSCOMP41CACHE\n");
+    fprintf(stderr,"       -P DAYS remove the entries of the cache that were not used for DAYS days,\n");
+    fprintf(stderr,"          all entries if DAYS is 0\n");
+    fprintf(stderr,"       -j JOBS number of input files that are compiled in parallel with -o\n");
     fprintf(stderr,"       -x XROMFILE specifies a file with definitions for functions in plug-in-modules\n");
     fprintf(stderr,"          This option can be repeated several times.\n");
     fprintf(stderr,"       if INPUTFILE is omitted, the input comes from standard input\n");
     fprintf(stderr,"\n");
   }
 
-int comp41 (int argc, char **argv)
+static void comp41_reset_unit(COMP41_UNIT *unit)
+{
+   // start the compilation of a new source file, keep the options
+   int i;
+
+   unit->global_label=0;
+   unit->global_count=0;
+   unit->global_end=0;
+   unit->source_line = (char *) NULL;
+   unit->errflag=0 ;
+   unit->source_line_counter=0;
+   unit->numeric_entry=0;
+   unit->error_column=0;
+   unit->lexer.arena.mem= (char *) NULL;
+   unit->lexer.arena.size=0;
+   unit->byte_counter=0;
+   for( i = 0; i < OPT41_RULES; ++i ) unit->saved[ i ]=0;
+}
+
+static int comp41_compile_unit(COMP41_UNIT *unit, FILE *fp)
 {
-   FILE * fp;
    char * line= (char *) NULL;
    size_t len = 0;
    ssize_t read;
+   int i;
+   int code_count;
+   int regs;
+
+   comp41_reset_unit(unit);
+
+   // main loop, read an process lines of input file
+   while ((read = getline(&line, &len, fp)) != -1) {
+      // remove line end, the last line may have none
+      if(read > 0 && line[read-1]== '\n') line[--read]='\0';
+      if(read > 0 && line[read-1]== '\r') line[--read]='\0';
+      unit->source_line_counter++;
+      unit->source_line= line;
+      if(unit->source_listing) {
+         fprintf(unit->msg," %4.4d  %s\n",unit->source_line_counter,unit->source_line);
+      }
+         
+      if( !unit->global_end && comp41_lex_line( unit, line )) {
+#if (DEBUG>0)
+         for(i=0;i<unit->lexer.ntokens;i++)fprintf(stderr,"%d:%s|",unit->lexer.token[i].type,unit->lexer.token[i].word);
+         fprintf(stderr,"\n");
+#endif
+         if( unit->lexer.more_column ) {
+            unit->error_column = unit->lexer.more_column;
+            comp41_print_error(unit,"too many arguments");
+            code_count = 0;
+         }
+         else {
+            // compile next instruction
+            code_count = comp41_compile_tokens( unit );
+         }
+
+         // list bytecode of line
+         if( code_count != 0 ) {
+             if(unit->source_listing && unit->code_listing) {
+                 fprintf(unit->msg,"        ");
+                 for(i=0;i<code_count;i++) {
+                     fprintf(unit->msg,"%2.2X ",(unsigned char) unit->code_buffer[i]);
+                 }
+                 fprintf(unit->msg,"\n");
+             }
+         
+         }
+         // append byte code of line to code buffer
+         if(unit->byte_counter+code_count > MEMORY_SIZE) {
+            fprintf(unit->msg,"Error: code buffer size exceeded\n");
+            free(line);
+            free(unit->lexer.arena.mem);
+            return(RETURN_ERROR);
+         }
+         memcpy(unit->memory+unit->byte_counter,unit->code_buffer,code_count);
+         unit->byte_counter+=code_count;
+      }
+   }
+
+   // exit on any error
+   free(line);
+   free(unit->lexer.arena.mem);
+   if( unit->errflag) {
+      if(unit->source_name != (char *) NULL) fprintf(unit->msg,"%s: ",unit->source_name);
+      fprintf(unit->msg,"error(s) in compilation\n");
+      return(RETURN_ERROR);
+   }
+
+   // END handling
+   if (! unit->global_end) { /* Append End statement */
+      comp41_compile_end(unit->code_buffer,unit->global_count);
+      if(unit->byte_counter+3 > MEMORY_SIZE) {
+         fprintf(unit->msg,"code buffer exceeded\n");
+         return(RETURN_ERROR);
+      }
+      memcpy(unit->memory+unit->byte_counter,unit->code_buffer,3);
+      unit->byte_counter+=3;
+      if(unit->source_listing) {
+         fprintf(unit->msg, "END statement appended.\n");
+         if(unit->code_listing) {
+             fprintf(unit->msg,"        ");
+             for(i=0;i<3;i++) {
+                 fprintf(unit->msg,"%2.2X ",(unsigned char) unit->code_buffer[i]);
+             }
+             fprintf(unit->msg,"\n");
+         }
+      }
+   }
+
+   // optimize before the jump distances are computed
+   if(unit->optimize) {
+      unit->byte_counter=opt41_optimize(unit->memory,unit->byte_counter,unit->saved);
+      if(unit->source_name != (char *) NULL) fprintf(unit->msg,"%s: ",unit->source_name);
+      opt41_report(unit->msg,unit->saved);
+   }
+
+   // enter the distances of the local jumps
+   jump41_compile(unit->memory,unit->byte_counter,1);
+
+   // compute and output required number of registers
+   if(unit->source_listing) {
+      regs=unit->byte_counter /7;
+      if(regs * 7 < unit->byte_counter) {
+         ++regs;
+      }
+      fprintf(unit->msg,"\nProgram size %d bytes, registers needed %d\n",unit->byte_counter,regs);
+   }
+   return(RETURN_OK);
+}
+
+static int comp41_compile_cached(COMP41_UNIT *unit, FILE *fp)
+{
+   // compile with the cache. The key is the hash of the options, the
+   // loaded XROM functions and the source. The source is copied to a
+   // temporary file while it is hashed, because standard input cannot be
+   // read twice. The messages of a compilation are stored with the
+   // program and output again on a hit
+   FILE *source, *messages, *msg;
+   unsigned long long key;
+   char buffer[4096];
+   size_t n;
+   int ret;
+
+   if(unit->cache_dir == (char *) NULL) return(comp41_compile_unit(unit,fp));
+   source=tmpfile();
+   messages=tmpfile();
+   if(source == (FILE *) NULL || messages == (FILE *) NULL) {
+      if(source != (FILE *) NULL) fclose(source);
+      if(messages != (FILE *) NULL) fclose(messages);
+      return(comp41_compile_unit(unit,fp));
+   }
+
+   key=cache41_hash_string(CACHE41_HASH_INIT,"comp41");
+   sprintf(buffer,"%d %d %d %d %d",unit->line_numbers,unit->force_global,
+           unit->source_listing,unit->code_listing,unit->optimize);
+   key=cache41_hash_string(key,buffer);
+   key=cache41_hash_string(key,unit->source_name == (char *) NULL ? "" : unit->source_name);
+   key=hash_xrom(key);
+   while((n=fread(buffer,1,sizeof(buffer),fp)) > 0) {
+      key=cache41_hash(key,buffer,n);
+      fwrite(buffer,1,n,source);
+   }
+
+   if(cache41_get(unit->cache_dir,key,unit->memory,&unit->byte_counter,unit->msg)) {
+      ret=RETURN_OK;
+   } else {
+      rewind(source);
+      msg=unit->msg;
+      unit->msg=messages;
+      ret=comp41_compile_unit(unit,source);
+      unit->msg=msg;
+      rewind(messages);
+      while((n=fread(buffer,1,sizeof(buffer),messages)) > 0)
+         fwrite(buffer,1,n,unit->msg);
+      // failed compilations are not stored
+      if(ret == RETURN_OK)
+         cache41_put(unit->cache_dir,key,unit->memory,unit->byte_counter,messages);
+   }
+   fclose(source);
+   fclose(messages);
+   return(ret);
+}
+
+static void comp41_create_entry(unsigned char *dir_entry, char *lif_filename, int start,
+                                int byte_counter)
+{
+   // directory entry of a program file
+   create_entry(dir_entry,lif_filename,0xE080,start,byte_counter+1,0);
+
+   // Implementation bytes for HP41 files 
+   dir_entry[28]=byte_counter >> 8;
+   dir_entry[29]=byte_counter & 0xff;
+   dir_entry[30]=0x00;
+   dir_entry[31]=0x20;
+}
+
+static int comp41_checksum(unsigned char *code, int byte_counter)
+{
+   int i, checksum;
+
+   checksum=0;
+   for (i=0;i< byte_counter;i++) checksum+= (int) code[i];
+   return(checksum & 0xff);
+}
+
+static int comp41_lif_name(char *name, char *source)
+{
+   // the LIF file name is the base name of the source file without
+   // extension in upper case
+   char *p;
+   int i;
+
+   p=strrchr(source,'/');
+   if(p == (char *) NULL) p=strrchr(source,'\\');
+   p= p == (char *) NULL ? source : p+1;
+   for(i=0; p[i] != '\0' && p[i] != '.' && i < NAME_LEN; i++)
+      name[i]= toupper((unsigned char) p[i]);
+   name[i]='\0';
+   if(p[i] != '\0' && p[i] != '.') return(0);
+   return(check_filename(name,0));
+}
+
+static int comp41_compile_program(COMP41_UNIT *unit, struct comp41_program *prog)
+{
+   FILE *fp;
+
+   prog->code= (unsigned char *) NULL;
+   prog->byte_counter=0;
+   fp=fopen(prog->source,"r");
+   if (fp == NULL) {
+      fprintf(unit->msg,"Error: cannot open input file %s\n",prog->source);
+      return(RETURN_ERROR);
+   }
+   unit->source_name=prog->source;
+   prog->status=comp41_compile_cached(unit,fp);
+   fclose(fp);
+   if(prog->status != RETURN_OK) return(RETURN_ERROR);
+   prog->code=malloc(unit->byte_counter);
+   if(prog->code == (unsigned char *) NULL) {
+      fprintf(stderr,"Cannot allocate memory\n");
+      exit(1);
+   }
+   memcpy(prog->code,unit->memory,unit->byte_counter);
+   prog->byte_counter=unit->byte_counter;
+   return(RETURN_OK);
+}
+
+#ifdef HAVE_FORK
+static int comp41_read_fd(int fd, void *data, int length)
+{
+   // read length bytes from a pipe, return the number of bytes read
+   int n, count;
+
+   count=0;
+   while(count < length && (n=read(fd,(char *) data+count,length-count)) > 0)
+      count+=n;
+   return(count);
+}
+
+static void comp41_write_fd(int fd, void *data, int length)
+{
+   int n;
+
+   while(length > 0 && (n=write(fd,data,length)) > 0) {
+      data= (char *) data+n;
+      length-=n;
+   }
+}
+
+static void comp41_compile_worker(COMP41_UNIT *unit, struct comp41_program *prog, int fd)
+{
+   // compile in a child process and send the status, the byte code and
+   // the messages through the pipe fd. The messages are collected in a
+   // temporary file, thus they are not mixed with those of other files
+   int header[2];
+   char buffer[4096];
+   size_t n;
+
+   unit->msg=tmpfile();
+   if(unit->msg == (FILE *) NULL) unit->msg=stderr;
+   comp41_compile_program(unit,prog);
+   header[0]=prog->status;
+   header[1]=prog->byte_counter;
+   comp41_write_fd(fd,header,sizeof(header));
+   comp41_write_fd(fd,prog->code,prog->byte_counter);
+   if(unit->msg != stderr) {
+      rewind(unit->msg);
+      while((n=fread(buffer,1,sizeof(buffer),unit->msg)) > 0)
+         comp41_write_fd(fd,buffer,n);
+   }
+}
+
+static void comp41_receive_program(struct comp41_program *prog, int fd)
+{
+   int header[2];
+   char buffer[4096];
+   ssize_t n;
+
+   prog->status=RETURN_ERROR;
+   if(comp41_read_fd(fd,header,sizeof(header)) == sizeof(header) &&
+      header[1] >= 0 && header[1] <= MEMORY_SIZE) {
+      prog->code=malloc(header[1]+1);
+      if(prog->code == (unsigned char *) NULL) {
+         fprintf(stderr,"Cannot allocate memory\n");
+         exit(1);
+      }
+      if(comp41_read_fd(fd,prog->code,header[1]) == header[1]) {
+         prog->status=header[0];
+         prog->byte_counter=header[1];
+      }
+   }
+   while((n=read(fd,buffer,sizeof(buffer))) > 0)
+      fwrite(buffer,1,n,stderr);
+}
+#endif
+
+static void comp41_compile_all(COMP41_UNIT *unit, struct comp41_program *progs,
+                               int num_progs, int jobs)
+{
+   // compile the programs, at most jobs at a time. The messages are
+   // output in the order of the source files
+   int i;
+#ifdef HAVE_FORK
+   int next, fd[2], status;
+   int *fds;
+   pid_t *pids;
+
+   if(jobs > 1 && num_progs > 1) {
+      fds=malloc(num_progs*sizeof(int));
+      pids=malloc(num_progs*sizeof(pid_t));
+      if(fds==NULL || pids==NULL) {
+         fprintf(stderr,"Cannot allocate memory\n");
+         exit(1);
+      }
+      next=0;
+      fflush(stdout);
+      fflush(stderr);
+      for(i=0; i<num_progs; i++) {
+         while(next < num_progs && next < i+jobs) {
+            if(pipe(fd)) {
+               fprintf(stderr,"Cannot create pipe\n");
+               exit(1);
+            }
+            pids[next]=fork();
+            if(pids[next] == (pid_t) -1) {
+               fprintf(stderr,"Cannot create process\n");
+               exit(1);
+            }
+            if(pids[next]==0) {
+               close(fd[0]);
+               comp41_compile_worker(unit,progs+next,fd[1]);
+               close(fd[1]);
+               _exit(0);
+            }
+            close(fd[1]);
+            fds[next]=fd[0];
+            next++;
+         }
+         comp41_receive_program(progs+i,fds[i]);
+         close(fds[i]);
+         waitpid(pids[i],&status,0);
+         if(! WIFEXITED(status) || WEXITSTATUS(status)!=0) progs[i].status=RETURN_ERROR;
+      }
+      free(fds);
+      free(pids);
+      return;
+   }
+#else
+   (void) jobs;
+#endif
+   unit->msg=stderr;
+   for(i=0; i<num_progs; i++) {
+      progs[i].status=comp41_compile_program(unit,progs+i);
+   }
+}
+
+struct comp41_extent {
+   int start;
+   int length;
+};
+
+static int comp41_cmp_extent(const void *p1, const void *p2)
+{
+   return(((struct comp41_extent *) p1)->start - ((struct comp41_extent *) p2)->start);
+}
+
+static int comp41_put_programs(char *image, struct comp41_program *progs, int num_progs)
+{
+   // put the compiled programs into the LIF image file. The directory is
+   // read and checked once, then the programs are written and finally
+   // the modified directory blocks are written in one operation. Nothing
+   // is written if a program does not fit.
+   int lif_device;
+   unsigned char dir_data[SECTOR_SIZE];
+   unsigned char *dir, *entry, *data;
+   unsigned char padded_name[NAME_LEN];
+   struct comp41_extent *extents;
+   int *starts, *entries;
+   int dir_start, dir_length, medium_size, num_entries, dir_end;
+   int num_extents, free_entry, first_entry, last_entry;
+   int i, k, blocks, length, start, file_type, ret;
+
+   if((lif_device=lif_open(image,O_RDWR | O_BINARY,0,0))==-1) {
+      fprintf(stderr,"Error opening %s\n",image);
+      return(RETURN_ERROR);
+   }
+   lif_read_block(lif_device,0,dir_data);
+   if(get_lif_int(dir_data+0,2)!=0x8000) {
+      fprintf(stderr,"This is not a LIF disk!\n");
+      lif_close(lif_device);
+      return(RETURN_ERROR);
+   }
+   dir_start=get_lif_int(dir_data+8,4);
+   dir_length=get_lif_int(dir_data+16,4);
+   medium_size=get_lif_int(dir_data+24,4)*get_lif_int(dir_data+28,4)*get_lif_int(dir_data+32,4);
+
+   // read the directory and collect the extents of the files
+   num_entries=dir_length*8;
+   dir=malloc((size_t) dir_length*SECTOR_SIZE);
+   extents=malloc((num_entries+num_progs+1)*sizeof(struct comp41_extent));
+   starts=malloc(num_progs*sizeof(int));
+   entries=malloc(num_progs*sizeof(int));
+   if(dir == NULL || extents == NULL || starts == NULL || entries == NULL) {
+      fprintf(stderr,"Cannot allocate memory\n");
+      exit(1);
+   }
+   lif_read_blocks(lif_device,dir_start,dir_length,dir);
+   num_extents=0;
+   dir_end=num_entries;
+   ret=RETURN_OK;
+   for(i=0; i< num_entries; i++) {
+      entry=dir+i*ENTRY_SIZE;
+      file_type=get_lif_int(entry+10,2);
+      if(file_type == 0xFFFF) {
+         dir_end=i;
+         break;
+      }
+      if(file_type == 0) continue;
+      extents[num_extents].start=get_lif_int(entry+12,4);
+      extents[num_extents].length=get_lif_int(entry+16,4);
+      num_extents++;
+      for(k=0; k< num_progs; k++) {
+         pad_name(progs[k].name,(char *) padded_name);
+         if(compare_names((char *) entry,(char *) padded_name)) {
+            fprintf(stderr,"Duplicate filename: %s\n",progs[k].name);
+            ret=RETURN_ERROR;
+         }
+      }
+   }
+
+   // allocate a directory entry and the first free extent for each program
+   free_entry=0;
+   first_entry=num_entries;
+   last_entry=dir_end-1;
+   for(k=0; k< num_progs && ret == RETURN_OK; k++) {
+      while(free_entry < dir_end && get_lif_int(dir+free_entry*ENTRY_SIZE+10,2) != 0)
+         free_entry++;
+      if(free_entry >= num_entries) {
+         fprintf(stderr,"Directory full\n");
+         ret=RETURN_ERROR;
+         break;
+      }
+      entries[k]=free_entry;
+      if(free_entry < first_entry) first_entry=free_entry;
+      if(free_entry > last_entry) last_entry=free_entry;
+      free_entry++;
+
+      length=progs[k].byte_counter+1;
+      blocks=filelength_in_blocks(length);
+      qsort(extents,num_extents,sizeof(struct comp41_extent),comp41_cmp_extent);
+      extents[num_extents].start=medium_size;
+      extents[num_extents].length=0;
+      start=dir_start+dir_length;
+      for(i=0; i<= num_extents; i++) {
+         if(extents[i].start - start >= blocks) break;
+         if(extents[i].start+extents[i].length > start)
+            start=extents[i].start+extents[i].length;
+      }
+      if(i > num_extents) {
+         fprintf(stderr,"No room for %s\n",progs[k].name);
+         ret=RETURN_ERROR;
+         break;
+      }
+      starts[k]=start;
+      extents[num_extents].start=start;
+      extents[num_extents].length=blocks;
+      num_extents++;
+   }
+
+   if(ret == RETURN_OK) {
+      // write the programs
+      for(k=0; k< num_progs; k++) {
+         length=progs[k].byte_counter+1;
+         blocks=filelength_in_blocks(length);
+         data=calloc(blocks,SECTOR_SIZE);
+         if(data == (unsigned char *) NULL) {
+            fprintf(stderr,"Cannot allocate memory\n");
+            exit(1);
+         }
+         memcpy(data,progs[k].code,progs[k].byte_counter);
+         data[progs[k].byte_counter]=comp41_checksum(progs[k].code,progs[k].byte_counter);
+         lif_write_blocks(lif_device,starts[k],blocks,data);
+         free(data);
+         pad_name(progs[k].name,(char *) padded_name);
+         comp41_create_entry(dir+entries[k]*ENTRY_SIZE,(char *) padded_name,starts[k],
+                             progs[k].byte_counter);
+      }
+
+      // move the end of directory mark behind the new entries
+      if(last_entry >= dir_end && last_entry+1 < num_entries) {
+         entry=dir+(last_entry+1)*ENTRY_SIZE;
+         memset(entry,0,ENTRY_SIZE);
+         entry[10]=0xFF;
+         entry[11]=0xFF;
+         last_entry++;
+      }
+
+      // commit the modified directory blocks
+      lif_write_blocks(lif_device,dir_start+first_entry/8,last_entry/8-first_entry/8+1,
+                       dir+(first_entry/8)*SECTOR_SIZE);
+   }
+   free(dir);
+   free(extents);
+   free(starts);
+   free(entries);
+   lif_close(lif_device);
+   return(ret);
+}
+
+static int comp41_image(COMP41_UNIT *unit, char *image, char **sources, int num_sources,
+                        int jobs)
+{
+   // compile the source files and put them into a LIF image file
+   struct comp41_program *progs;
+   int i, k, ret;
+
+   progs=calloc(num_sources,sizeof(struct comp41_program));
+   if(progs == (struct comp41_program *) NULL) {
+      fprintf(stderr,"Cannot allocate memory\n");
+      exit(1);
+   }
+   ret=RETURN_OK;
+   for(i=0; i< num_sources; i++) {
+      progs[i].source=sources[i];
+      if(comp41_lif_name(progs[i].name,sources[i])==0) {
+         fprintf(stderr,"Error: illegal LIF filename for %s\n",sources[i]);
+         ret=RETURN_ERROR;
+      }
+      for(k=0; k< i; k++) {
+         if(strcmp(progs[k].name,progs[i].name)==0) {
+            fprintf(stderr,"Error: %s and %s have the same LIF filename\n",sources[k],sources[i]);
+            ret=RETURN_ERROR;
+         }
+      }
+   }
+
+   if(ret == RETURN_OK) {
+      comp41_compile_all(unit,progs,num_sources,jobs);
+      for(i=0; i< num_sources; i++) {
+         if(progs[i].status != RETURN_OK) ret=RETURN_ERROR;
+      }
+   }
+   if(ret == RETURN_OK) ret=comp41_put_programs(image,progs,num_sources);
+
+   for(i=0; i< num_sources; i++) free(progs[i].code);
+   free(progs);
+   return(ret);
+}
+
+int comp41 (int argc, char **argv)
+{
+   FILE * fp;
    int i,j;
 
-   static int line_argc;
-   static int code_count;
-   static char *line_argv[ MAX_ARGS ];
-   static unsigned char code_buffer[ MAX_CODE ];
-   unsigned char memory[MEMORY_SIZE]; /* compiled program */
+   static COMP41_UNIT unit;
    unsigned char dir_entry[ENTRY_SIZE];
    char lif_filename[NAME_LEN+1];
-   int checksum;
-   static int byte_counter=0;
-   static int regs;
+   char *image;
+   int create_lif;
+   int jobs;
+   int prune_days;
+   int ret;
    int option;
 
-   /* init global struct */
-   comp41glo.global_label=0;
-   comp41glo.global_count=0;
-   comp41glo.global_end=0;
-   comp41glo.line_numbers=0;
-   comp41glo.force_global=0;
-   comp41glo.source_listing=0;
-   comp41glo.code_listing=0;
-   comp41glo.create_lif=0;
-   comp41glo.source_line = (char *) NULL;
-   comp41glo.errflag=0 ;
-   comp41glo.source_line_counter=0;
+   /* init options */
+   unit.line_numbers=0;
+   unit.force_global=0;
+   unit.source_listing=0;
+   unit.code_listing=0;
+   unit.optimize=0;
+   unit.source_name= (char *) NULL;
+   unit.cache_dir=getenv("LIFUTILSCOMP41CACHE");
+   unit.msg=stderr;
+   create_lif=0;
+   prune_days= -1;
+   image= (char *) NULL;
+   jobs=1;
+#if defined(HAVE_FORK) && defined(_SC_NPROCESSORS_ONLN)
+   jobs=(int) sysconf(_SC_NPROCESSORS_ONLN);
+   if(jobs < 1) jobs=1;
+#endif
  
 
   optind=1;
   init_xrom();
+  comp41_init_mnemonics();
 
   // program option processing
-  while((option=getopt(argc,argv,"f:ghlsx:?"))!=-1)
+  while((option=getopt(argc,argv,"c:f:ghj:lOo:P:sx:?"))!=-1)
     {
       switch(option)
         {
-          case 'f' : comp41glo.create_lif=1;
+          case 'c' : unit.cache_dir=optarg;
+                     break;
+          case 'P' : if(sscanf(optarg,"%d",&prune_days)!=1 || prune_days < 0) {
+                         comp41_usage();
+                         return(RETURN_ERROR);
+                     }
+                     break;
+          case 'f' : create_lif=1;
                      if(check_filename(optarg,0)==0) {
                          fprintf(stderr,"Error: illegal LIF filename\n");      
                          return(RETURN_ERROR);
                      }
                      pad_name(optarg,lif_filename);
                      break;
-          case 'g' : comp41glo.force_global=1;
+          case 'g' : unit.force_global=1;
+                     break;
+          case 'j' : if(sscanf(optarg,"%d",&jobs)!=1 || jobs < 1) {
+                         comp41_usage();
+                         return(RETURN_ERROR);
+                     }
+                     break;
+          case 'O' : unit.optimize=1;
+                     break;
+          case 'o' : image=optarg;
                      break;
           case 'x' : read_xrom(optarg);
                      break;
-          case 'l' : comp41glo.line_numbers=1;
+          case 'l' : unit.line_numbers=1;
                      break;
-          case 's' : comp41glo.source_listing=1;
+          case 's' : unit.source_listing=1;
                      break;
-          case 'h' : comp41glo.code_listing=1;
+          case 'h' : unit.code_listing=1;
                      break;
           case '?' : comp41_usage();
                      return(RETURN_OK);
          }
     }
+
+   // remove unused entries from the cache
+   if(prune_days >= 0) {
+      if(unit.cache_dir == (char *) NULL || optind != argc) {
+         comp41_usage();
+         return(RETURN_ERROR);
+      }
+      ret=cache41_prune(unit.cache_dir,prune_days);
+      if(ret < 0) return(RETURN_ERROR);
+      printf("%d cache %s removed\n",ret,ret == 1 ? "entry" : "entries");
+      return(RETURN_OK);
+   }
+
+   // compile into a LIF image file
+   if(image != (char *) NULL) {
+      if(create_lif || optind == argc) {
+         comp41_usage();
+         return(RETURN_ERROR);
+      }
+      return(comp41_image(&unit,image,argv+optind,argc-optind,jobs));
+   }
+
     if((optind!=argc) && (optind!= argc-1))
       {
         comp41_usage();
@@ -174,115 +833,14 @@ int comp41 (int argc, char **argv)
 
    SETMODE_STDOUT_BINARY;
 
-   // main loop, read an process lines of input file
-   while ((read = getline(&line, &len, fp)) != -1) {
-      if(line[read-2]== '\r') {
-          line[read-2]='\0';
-      } else {
-          line[read-1]='\0';
-      }
-      comp41glo.source_line_counter++;
-      comp41glo.source_line= line;
-      if(comp41glo.source_listing) {
-         fprintf(stderr," %4.4d  %s\n",comp41glo.source_line_counter,comp41glo.source_line);
-      }
-         
-      if( !comp41glo.global_end &&
-         ( line_argc = comp41_get_line_args( line_argv, &line ))) {
-#if (DEBUG>0)
-         for(i=0;i<line_argc;i++)fprintf(stderr,"%s|",line_argv[i]);
-         fprintf(stderr,"\n");
-#endif
-         if( line_argc == MAX_ARGS && strlen( line )) {
-            comp41_print_error("too many arguments");
-            /*
-            fprintf(stderr, "Error: too many arguments[" );
-            for( line_argc=0; line_argc<MAX_ARGS; ++line_argc )
-                fprintf(stderr, " %s", line_argv[ line_argc ] );
-            fprintf(stderr, " %s ]\n", line );
-            */
-            code_count = 0;
-         }
-         else {
-            // compile next instruction
-            code_count = comp41_compile_args( code_buffer, line_argc, line_argv );
-         }
-
-         // list bytecode of line
-         if( code_count != 0 ) {
-             if(comp41glo.source_listing && comp41glo.code_listing) {
-                 fprintf(stderr,"        ");
-                 for(i=0;i<code_count;i++) {
-                     fprintf(stderr,"%2.2X ",(unsigned char) code_buffer[i]);
-                 }
-                 fprintf(stderr,"\n");
-             }
-         
-         }
-         // append byte code of line to code buffer
-         for(i=0;i<code_count;i++) {
-            memory[byte_counter]=code_buffer[i];
-            if(byte_counter > MEMORY_SIZE) {
-               fprintf(stderr,"Error: code buffer size exceeded\n");
-               if(fp!=stdin)fclose(fp);
-               return(RETURN_ERROR);
-            }
-            byte_counter++;
-         }
-      }
-      line= comp41glo.source_line; // needed, because line is modified in get_line_args
-   }
-
-   // exit on any error
+   ret=comp41_compile_cached(&unit,fp);
    if(fp != stdin) fclose(fp);
-   if( comp41glo.errflag) {
-      fprintf(stderr,"error(s) in compilation\n");
-      return(RETURN_ERROR);
-   }
-
-   // END handling
-   if (! comp41glo.global_end) { /* Append End statement */
-      comp41_compile_end(code_buffer,comp41glo.global_count);
-      for(i=0;i<3;i++) {
-         memory[byte_counter]=code_buffer[i];
-         byte_counter++;
-         if(byte_counter > MEMORY_SIZE) {
-            fprintf(stderr,"code buffer exceeded\n");
-            if(fp!=stdin)fclose(fp);
-            return(RETURN_ERROR);
-         }
-      }
-      if(comp41glo.source_listing) {
-         fprintf(stderr, "END statement appended.\n");
-         if(comp41glo.code_listing) {
-             fprintf(stderr,"        ");
-             for(i=0;i<3;i++) {
-                 fprintf(stderr,"%2.2X ",(unsigned char) code_buffer[i]);
-             }
-             fprintf(stderr,"\n");
-         }
-      }
-   }
-
-   // compute and output required number of registers
-   if(comp41glo.source_listing) {
-      regs=byte_counter /7;
-      if(regs * 7 < byte_counter) {
-         ++regs;
-      }
-      fprintf(stderr,"\nProgram size %d bytes, registers needed %d\n",byte_counter,regs);
-   }
+   if(ret != RETURN_OK) return(RETURN_ERROR);
 
    // create lif header if requested
-   if(comp41glo.create_lif) {
+   if(create_lif) {
      // create and write directory entry 
-     create_entry(dir_entry,lif_filename,0xE080,0,byte_counter+1,0);
-
-     // Implementation bytes for HP41 files 
-     dir_entry[28]=byte_counter >> 8;
-     dir_entry[29]=byte_counter & 0xff;
-     dir_entry[30]=0x00;
-     dir_entry[31]=0x20;
+     comp41_create_entry(dir_entry,lif_filename,0,unit.byte_counter);
      
      // output lif header to result file
      for(i=0;i< ENTRY_SIZE; i++) {
@@ -290,30 +848,110 @@ int comp41 (int argc, char **argv)
      }
    }
 
-   // compute checksum and write byte code to result file 
-   checksum=0;
-   for (i=0;i< byte_counter;i++) {
-      putchar(memory[i]);
-      checksum+= (int) memory[i];
+   // write byte code to result file 
+   for (i=0;i< unit.byte_counter;i++) {
+      putchar(unit.memory[i]);
    }
 
    // write checksum and trailer bytes to lif file 
-   if(comp41glo.create_lif) {
-      checksum= checksum & 0xff;
-      putchar((int) checksum);
-      j= SECTOR_SIZE- ((byte_counter+1) % SECTOR_SIZE);
+   if(create_lif) {
+      putchar(comp41_checksum(unit.memory,unit.byte_counter));
+      j= SECTOR_SIZE- ((unit.byte_counter+1) % SECTOR_SIZE);
       for (i=0; i<j;i++) putchar(0);
    }
    return(RETURN_OK);
 }
 
-int comp41_get_line_args( char *line_argv[],char  **line_ptr )
+//
+// Lexer: a source line is split into words in one pass, quoted text is
+// kept as a unit and ", " ends the instruction. The words are copied to
+// the arena of the compilation, the source line is not modified. Then the
+// words are classified once into typed tokens, which the parser
+// comp41_compile_tokens consumes:
+//
+//  1 word:  NUMBER, TEXT or WORD
+//  2 words: NUMBER ("1 E5"), TEXT (T "abc"), WORD ALPHA or WORD WORD
+//  3 words: WORD ALPHA KEY or WORD WORD WORD
+//  4 words: WORD ALPHA KEY ("Key: 11")
+//
+// A leading line number is dropped if line numbers are skipped.
+//
+
+static void comp41_arena_reset( ARENA *arena, size_t size )
 {
-   char *pc;
-   int i, j, count, done;
+    // the arena holds the tokens of one line only, grow it as needed
+    if( size > arena->size ) {
+        free( arena->mem );
+        arena->mem = malloc( size );
+        if( arena->mem == ( char * ) NULL ) {
+            fprintf(stderr,"Cannot allocate memory\n");
+            exit(1);
+        }
+        arena->size = size;
+    }
+    arena->used = 0;
+}
+
+
+static char *comp41_arena_alloc( ARENA *arena, size_t size )
+{
+   char *p;
+
+    p = arena->mem + arena->used;
+    arena->used += size;
+    return( p );
+}
+
+
+static char *comp41_arena_join( ARENA *arena, char *word1, char *word2 )
+{
+   char *p;
+   size_t len1, len2;
+
+    len1 = strlen( word1 );
+    len2 = strlen( word2 );
+    p = comp41_arena_alloc( arena, len1 + len2 + 1 );
+    memcpy( p, word1, len1 );
+    memcpy( p + len1, word2, len2 + 1 );
+    return( p );
+}
+
+
+static int comp41_is_numeric_word( char *word )
+{
+    // only these characters are accepted by comp41_get_numeric_prefix
+    return( word[ strspn( word, "0123456789.,Ee+-" ) ] == '\0' );
+}
+
+
+static void comp41_set_token( TOKEN *token, int type, char *word, int column )
+{
+    token->type = type;
+    token->word = word;
+    token->column = column;
+    token->text = word;
+    token->count = 0;
+}
 
+
+int comp41_lex_line( COMP41_UNIT *unit, char *line )
+{
+   char *pc, *word, *buffer;
+   char *words[ MAX_ARGS ];
+   int columns[ MAX_ARGS ];
+   int i, j, count, base, done;
+   size_t len;
+   TOKEN *token;
+   LEXER *lexer = &unit->lexer;
+
+    len = strlen( line );
+    comp41_arena_reset( &lexer->arena, 4 * len + 64 );
+    lexer->ntokens = 0;
+    lexer->more_column = 0;
+
+    // split the line into words
     count = 0;
-    pc = *line_ptr;
+    pc = line;
     done = ( *pc == '\0' ) ? 1 : 0;
     while( !done ) {
         // ignore leading spaces
@@ -329,7 +967,7 @@ int comp41_get_line_args( char *line_argv[],char  **line_ptr )
         else {
             // get argument
             i = 0;
-            do {
+            for( ;; ) {
                 // consider quotes as a unit
                 j = comp41_is_inquotes( &pc[ i++ ] );
                 i += j;
@@ -337,45 +975,107 @@ int comp41_get_line_args( char *line_argv[],char  **line_ptr )
                 // end of line?
                 if( pc[ i ] == '\0' ) {
                     done = 2;
+                    break;
                 }
                 // end of instruction?
-                else if( pc[ i ] == ',' ) {
-                    if( pc[ i+1 ] == '\t' ||
-                        pc[ i+1 ] == 0x20 ) {
-                        pc[ i ] = '\0';
-                        done = 1;
-                    }
+                if( pc[ i ] == ',' &&
+                  ( pc[ i+1 ] == '\t' || pc[ i+1 ] == 0x20 )) {
+                    done = 1;
+                    break;
                 }
                 // end of argument?
-                else if( pc[ i ] == '\t' ||
-                         pc[ i ] == 0x20 ) {
-                    pc[ i ] = '\0';
-                }
-            } while( pc[ i ] != '\0' );
+                if( pc[ i ] == '\t' || pc[ i ] == 0x20 )
+                    break;
+            }
 
             // put argument in list
-			line_argv[ count++ ] = pc;
+            word = comp41_arena_alloc( &lexer->arena, i + 1 );
+            memcpy( word, pc, i );
+            word[ i ] = '\0';
+            columns[ count ] = ( int )( pc - line ) + 1;
+            words[ count++ ] = word;
 
             // point to next argument
-            pc += strlen( pc );
+            pc += i;
             if( done != 2 )
                 ++pc;
 
             // full list?
             if( count == MAX_ARGS ) {
+                if( *pc != '\0' )
+                    lexer->more_column = ( int )( pc - line ) + 1;
                 done = 1;
             }
         }
     }
+    if( count == 0 || lexer->more_column )
+        return( count );
+
+    // skip line number
+    base = 0;
+    if( unit->line_numbers && isdigit(( unsigned char ) words[ 0 ][ 0 ] ))
+        base = 1;
+
+    // classify the words
+    token = lexer->token;
+    for( i = base; i < count; ++i )
+        comp41_set_token( &token[ i - base ], TOK_WORD, words[ i ], columns[ i ] );
+    lexer->ntokens = count - base;
+    if( lexer->ntokens == 0 )
+        return( count );
+
+    buffer = ( char * ) NULL;
+    switch( lexer->ntokens ) {
+        case 1:
+            if( comp41_is_numeric_word( token[ 0 ].word ))
+                buffer = token[ 0 ].word;
+            break;
+        case 2:
+            // number or text may be split into two words
+            if(( comp41_is_numeric_word( token[ 0 ].word ) &&
+                 comp41_is_numeric_word( token[ 1 ].word )) ||
+                 strpbrk( token[ 0 ].word, "\"'" ) ||
+                 strpbrk( token[ 1 ].word, "\"'" ))
+                buffer = comp41_arena_join( &lexer->arena, token[ 0 ].word, token[ 1 ].word );
+            break;
+        case 4:
+            // key assignment "Key: 11", other lines of 4 words are ignored
+            if( comp41_lex_alpha( &lexer->arena, &token[ 1 ] )) {
+                token[ 2 ].word = comp41_arena_join( &lexer->arena, token[ 2 ].word, token[ 3 ].word );
+                token[ 2 ].text = token[ 2 ].word;
+                token[ 2 ].type = TOK_KEY;
+                lexer->ntokens = 3;
+            }
+            return( count );
+    }
 
-    // update line pointer
-    *line_ptr = pc;
+    if( lexer->ntokens <= 2 ) {
+        // number?
+        if( buffer != ( char * ) NULL && comp41_is_numeric_word( buffer )) {
+            token[ 0 ].text = comp41_arena_alloc( &lexer->arena, 2 * strlen( buffer ) + 1 );
+            if( comp41_get_numeric_prefix( token[ 0 ].text, buffer )) {
+                token[ 0 ].type = TOK_NUMBER;
+                lexer->ntokens = 1;
+                return( count );
+            }
+        }
+        // text?
+        if( strpbrk( buffer ? buffer : token[ 0 ].word, "\"'" )) {
+            if( comp41_lex_text( &lexer->arena, &token[ 0 ], buffer ? buffer : token[ 0 ].word )) {
+                lexer->ntokens = 1;
+                return( count );
+            }
+        }
+        if( lexer->ntokens == 1 )
+            return( count );
+    }
 
+    // alpha postfix and key assignment
+    if( comp41_lex_alpha( &lexer->arena, &token[ 1 ] ) && lexer->ntokens == 3 )
+        token[ 2 ].type = TOK_KEY;
     return( count );
 }
 
-//#define MAX_NUMERIC     16
-#define MAX_NUMERIC     1500
 #define MAX_DIGITS      10
 #define MAX_INT         8
 #define MAX_EXP         2
@@ -384,7 +1084,7 @@ int comp41_get_line_args( char *line_argv[],char  **line_ptr )
 
 int comp41_get_numeric_prefix( char *numeric, char *tbuffer )
 {
-   int i;
+   int i, len;
    int error=0;
    int num_index=0;
    int num_decimal=0;
@@ -393,7 +1093,8 @@ int comp41_get_numeric_prefix( char *numeric, char *tbuffer )
    int exp_sign=0;
    int exp_digits=0;
 
-    for( i=0; i<(int)strlen( tbuffer ) && !error; ++i ) {
+    len = (int) strlen( tbuffer );
+    for( i=0; i<len && !error; ++i ) {
         if( exp_entry ) {
             if( tbuffer[ i ] == '+' ||
                 tbuffer[ i ] == '-' ) {
@@ -469,7 +1170,7 @@ int comp41_get_numeric_prefix( char *numeric, char *tbuffer )
                  tbuffer[ i ] == '-' ) {
             if( i == 0 ) {
                 if( tbuffer[ i ] == '-' &&
-                    strlen( tbuffer ) > 1 ) {
+                    len > 1 ) {
                     numeric[ num_index++ ] = tbuffer[ i ];
                 }
             }
@@ -500,78 +1201,62 @@ int comp41_get_numeric_prefix( char *numeric, char *tbuffer )
     // terminate string
     numeric[ num_index ] = '\0';
 
-    return( !error && strlen( numeric ) );
+    return( !error && num_index );
 }
 
 
-int comp41_get_text_prefix( char *text, char *tbuffer, int *pcount )
+int comp41_lex_text( ARENA *arena, TOKEN *token, char *tbuffer )
 {
-   int i, j, k;
-   int error=1;
-   char lbuffer[ MAX_LINE ];
+   int i, j, append;
+   char *text, *quote;
+   char prefix[ 8 ];
+
+    DLOG(stderr,"comp41_lex_text %s\n",tbuffer);
+    // get start-quote and end-quote
+    quote = strpbrk( tbuffer, "\"'" );
+    if( quote == ( char * ) NULL )
+        return( 0 );
+    j = ( int )( quote - tbuffer );
+    if(( i = comp41_is_inquotes( quote )) == 0 )
+        return( 0 );
 
-    DLOG(stderr,"comp41_get_text_prefix %s\n",tbuffer);
-    // get start-quote
-    j=0;
-    for( i=0, k=0; i<(int)strlen( tbuffer ) && k==0; ++i ) {
-        if( tbuffer[ i ] == '\"' ||
-            tbuffer[ i ] == '\'' ) {
-            j = i;
-            k = 1;
-        }
+    // append or text prefix?
+    append = 0;
+    if( j ) {
+        if( j >= ( int ) sizeof( prefix ))
+            return( 0 );
+        memcpy( prefix, tbuffer, j );
+        prefix[ j ] = '\0';
+        if( comp41_is_append( prefix ))
+            append = 1;
+        else if( !comp41_is_text( prefix ))
+            return( 0 );
     }
 
-    // start-quote?
-    if( k ) {
-        // end-quote?
-        if(( i = comp41_is_inquotes( &tbuffer[ j ] ))) {
-            // make string copy
-            strcpy( lbuffer, tbuffer );
-
-            // remove end-quote
-            lbuffer[ i+j ] = '\0';
-
-            // append text?
-            if( j ) {
-                // remove start-quote
-                lbuffer[ j ] = '\0';
-                if( comp41_is_append( lbuffer )) {
-                    lbuffer[ j ] = 0x7F;
-                    --j;
-                }
-                else if( !comp41_is_text( lbuffer )) {
-                    j = -1;
-                }
-            }
-
-            // parse for esc-sequence after start-quote
-            if( j >= 0 ) {
-                if( comp41_parse_text( text, &lbuffer[ j+1 ], pcount )) {
-                    error = 0;
-                }
-            }
-        }
-    }
-    return( !error );
+    // parse for esc-sequence after start-quote
+    text = comp41_arena_alloc( arena, MAX_ALPHA + 1 );
+    if( !comp41_parse_text( text, quote + 1, i - 1, append, &token->count ))
+        return( 0 );
+    token->type = TOK_TEXT;
+    token->text = text;
+    return( 1 );
 }
 
 
-int comp41_get_alpha_postfix( char *alpha, char *tbuffer, int *pcount)
+int comp41_lex_alpha( ARENA *arena, TOKEN *token )
 {
    int i;
-   char lbuffer[ MAX_LINE ];
+   char *alpha;
 
-    // end-quote?
-    if(( i = comp41_is_inquotes( tbuffer ))) {
-       // make string copy
-       strcpy( lbuffer, tbuffer );
-        // remove end-quote
-        lbuffer[ i ] = '\0';
-       if( comp41_parse_text( alpha, &lbuffer[ 1 ], pcount )) {
-           return(1);
-       }
-    }
-    return(0);
+    // quoted alpha postfix
+    if(( i = comp41_is_inquotes( token->word )) == 0 )
+        return( 0 );
+    alpha = comp41_arena_alloc( arena, MAX_ALPHA + 1 );
+    if( !comp41_parse_text( alpha, token->word + 1, i - 1, 0, &token->count ))
+        return( 0 );
+    token->type = TOK_ALPHA;
+    token->text = alpha;
+    return( 1 );
 }
 
 
@@ -608,7 +1293,7 @@ int comp41_compile_text(unsigned char *code, char *text, int count )
 }
 
 
-int comp41_compile_alpha(unsigned char *code, char *prefix, char *alpha, int count )
+int comp41_compile_alpha(COMP41_UNIT *unit, unsigned char *code, char *prefix, char *alpha, int count )
 {
    int j;
    int local;
@@ -621,12 +1306,13 @@ int comp41_compile_alpha(unsigned char *code, char *prefix, char *alpha, int cou
     // LBL "alpha"
     if( strcasecmp( prefix, "LBL" ) == 0 ) {
         if( count >= MAX_ALPHA ) {
-            sprintf(comp41glo.err_msg, "Error: alpha (global) postfix[ %s \"%s\" ] too long.\n",
+            sprintf(unit->err_msg, "Error: alpha (global) postfix[ %s \"%s\" ] too long.\n",
                      prefix, alpha );
-            comp41_print_error(comp41glo.err_msg);
+            unit->error_column = unit->token_column[ 1 ];
+            comp41_print_error(unit,unit->err_msg);
             return( 0 );
         }
-        else if( comp41glo.force_global || !local ) {
+        else if( unit->force_global || !local ) {
             code[ 0 ] = 0xC0;
             code[ 1 ] = 0x00;
             code[ 2 ] = 0xF1 + count;
@@ -635,8 +1321,8 @@ int comp41_compile_alpha(unsigned char *code, char *prefix, char *alpha, int cou
                 memcpy( &code[ 4 ], alpha, count );
 
             // set LABEL flag
-            comp41glo.global_label = 1;
-            comp41glo.global_count = 0;
+            unit->global_label = 1;
+            unit->global_count = 0;
             return( count + 4 );
         }
         else {
@@ -649,7 +1335,7 @@ int comp41_compile_alpha(unsigned char *code, char *prefix, char *alpha, int cou
     //  GTO "alpha"
     if( strcasecmp( prefix, "GTO" ) == 0 ||
         strcasecmp( prefix, "GOTO" ) == 0 ) {
-        if( comp41glo.force_global || !local ) {
+        if( unit->force_global || !local ) {
             code[ 0 ] = 0x1D;
             code[ 1 ] = 0xF0 + count;
             if( count )
@@ -666,7 +1352,7 @@ int comp41_compile_alpha(unsigned char *code, char *prefix, char *alpha, int cou
 
     //  XEQ "alpha"
     if( strcasecmp( prefix, "XEQ" ) == 0 ) {
-        if( comp41glo.force_global || !local ) {
+        if( unit->force_global || !local ) {
             code[ 0 ] = 0x1E;
             code[ 1 ] = 0xF0 + count;
             if( count )
@@ -700,31 +1386,166 @@ int comp41_compile_alpha(unsigned char *code, char *prefix, char *alpha, int cou
            code[ 1 ] = (( mm & 0x03 ) << 6 ) + ff;
            return( 2 );
         }
-        sprintf(comp41glo.err_msg, "Error: unrecognized alpha postfix[ %s \"%s\" ], try: [ XROM mm,ff ]\n",
+        sprintf(unit->err_msg, "Error: unrecognized alpha postfix[ %s \"%s\" ], try: [ XROM mm,ff ]\n",
                  prefix, to_hp41_string((unsigned char *)alpha,count,1) );
-        comp41_print_error(comp41glo.err_msg);
+        unit->error_column = unit->token_column[ 1 ];
+        comp41_print_error(unit,unit->err_msg);
         return( 0 );
     }
 
-    sprintf(comp41glo.err_msg, "Error: unrecognized prefix[ %s \"%s\" ]\n", prefix, alpha );
-    comp41_print_error(comp41glo.err_msg);
+    sprintf(unit->err_msg, "Error: unrecognized prefix[ %s \"%s\" ]\n", prefix, alpha );
+    comp41_print_error(unit,unit->err_msg);
     return( 0 );
 }
 
 
-int comp41_compile_arg1(unsigned char *code, char *prefix )
+//
+// Mnemonic index: all spellings of the functions and postfixes in the
+// tables of comp41.h are sorted once, a lookup is a binary search. If a
+// spelling occurs more than once, the entry that was added first wins,
+// this keeps the precedence of the former sequential table scans.
+//
+typedef enum {
+   MN_FCN1,     // single-byte function, e.g. "SIN" or "Σ+"
+   MN_SHORT,    // short form of a function with postfix, e.g. "RCL 05"
+   MN_PREFIX2,  // prefix of a 2-byte function with trailing blank, e.g. "SF "
+   MN_ALT2,     // alternate-form prefix of a 2-byte function, e.g. "STO+"
+   MN_POSTFIX,  // postfix, case sensitive, e.g. "05" or "X"
+} MNEMONIC_KIND;
+
+typedef struct {
+   char *name;
+   int kind;
+   int code;
+   int seq;     // insertion order
+} MNEMONIC;
+
+#define MAX_MNEMONICS 512
+
+static MNEMONIC mnemonics[ MAX_MNEMONICS ];
+static int mnemonic_count = 0;
+static char lower_postfix[ 16 ][ 2 ];   // "f".."r" of the postfixes 107..122
+
+
+static void comp41_add_mnemonic( char *name, int kind, int code )
+{
+    mnemonics[ mnemonic_count ].name = name;
+    mnemonics[ mnemonic_count ].kind = kind;
+    mnemonics[ mnemonic_count ].code = code;
+    mnemonics[ mnemonic_count ].seq = mnemonic_count;
+    ++mnemonic_count;
+}
+
+
+static int comp41_cmp_key( const void *p1, const void *p2 )
+{
+   const MNEMONIC *m1 = p1, *m2 = p2;
+   int ret;
+
+    // functions are case insensitive, postfixes are not
+    if( m1->kind != m2->kind )
+        return( m1->kind - m2->kind );
+    if( m1->kind == MN_POSTFIX )
+        ret = strcmp( m1->name, m2->name );
+    else
+        ret = strcasecmp( m1->name, m2->name );
+    return( ret );
+}
+
+
+static int comp41_cmp_mnemonic( const void *p1, const void *p2 )
+{
+   int ret;
+
+    ret = comp41_cmp_key( p1, p2 );
+    if( ret == 0 )
+        ret = (( const MNEMONIC * )p1 )->seq - (( const MNEMONIC * )p2 )->seq;
+    return( ret );
+}
+
+
+void comp41_init_mnemonics( void )
 {
    int i, j;
+   static char *append[] = { "~", ">", "|-", "\\-", ">-", "->" };
+
+    if( mnemonic_count )
+        return;
+
+    // single-byte functions, alternate forms first
+    for( i = 0; i < ( int )( sizeof( alt_fcn1 ) / sizeof( FCN )); ++i )
+        comp41_add_mnemonic( alt_fcn1[ i ].prefix, MN_FCN1, alt_fcn1[ i ].code );
+    for( i = 0x40; i <= 0x8F; ++i )
+        comp41_add_mnemonic( single20_8F[ i - 0x20 ], MN_FCN1, i );
+
+    // LBL 00..14, RCL 00..15, STO 00..15, GTO 00..14
+    for( i = 0x01; i <= 0x0F; ++i )
+        comp41_add_mnemonic( single01_1C[ i - 0x01 ], MN_SHORT, i );
+    for( i = 0x20; i <= 0x3F; ++i )
+        comp41_add_mnemonic( single20_8F[ i - 0x20 ], MN_SHORT, i );
+    for( i = 0xB1; i <= 0xBF; ++i )
+        comp41_add_mnemonic( prefixB1_BF[ i - 0xB1 ], MN_SHORT, i );
+
+    // 2-byte functions
+    for( i = 0x90; i <= 0x9F; ++i )
+        comp41_add_mnemonic( prefix90_9F[ i - 0x90 ], MN_PREFIX2, i );
+    for( i = 0xA8; i <= 0xAD; ++i )
+        comp41_add_mnemonic( prefixA8_AD[ i - 0xA8 ], MN_PREFIX2, i );
+    for( i = 0xCE; i <= 0xCF; ++i )
+        comp41_add_mnemonic( prefixCE_CF[ i - 0xCE ], MN_PREFIX2, i );
+    for( i = 0; i < ( int )( sizeof( alt_fcn2 ) / sizeof( FCN )); ++i )
+        comp41_add_mnemonic( alt_fcn2[ i ].prefix, MN_ALT2, alt_fcn2[ i ].code );
+
+    // postfixes, "F..R" are case insensitive
+    for( i = 0; i <= 127; ++i )
+        comp41_add_mnemonic( postfix00_7F[ i ], MN_POSTFIX, i );
+    for( i = 107; i <= 122; ++i ) {
+        lower_postfix[ i - 107 ][ 0 ] = tolower( postfix00_7F[ i ][ 0 ] );
+        lower_postfix[ i - 107 ][ 1 ] = '\0';
+        comp41_add_mnemonic( lower_postfix[ i - 107 ], MN_POSTFIX, i );
+    }
+    for( i = 102, j = 0; i <= 111; ++i, ++j )
+        comp41_add_mnemonic( alt_postfix102_111[ j ], MN_POSTFIX, i );
+    for( i = 117, j = 0; i <= 122; ++i, ++j )
+        comp41_add_mnemonic( alt_postfix117_122[ j ], MN_POSTFIX, i );
+    for( i = 0; i < ( int )( sizeof( append ) / sizeof( char * )); ++i )
+        comp41_add_mnemonic( append[ i ], MN_POSTFIX, 0x7A );
+
+    // sort and remove the duplicates added later
+    qsort( mnemonics, mnemonic_count, sizeof( MNEMONIC ), comp41_cmp_mnemonic );
+    for( i = 1, j = 1; i < mnemonic_count; ++i ) {
+        if( comp41_cmp_key( &mnemonics[ j - 1 ], &mnemonics[ i ] ) != 0 )
+            mnemonics[ j++ ] = mnemonics[ i ];
+    }
+    mnemonic_count = j;
+}
+
+
+static int comp41_lookup( char *name, int kind )
+{
+   MNEMONIC key, *found;
+
+    // return the code of a mnemonic or -1
+    key.name = name;
+    key.kind = kind;
+    found = bsearch( &key, mnemonics, mnemonic_count, sizeof( MNEMONIC ), comp41_cmp_key );
+    return( found ? found->code : -1 );
+}
+
+
+int comp41_compile_arg1(COMP41_UNIT *unit, unsigned char *code, char *prefix )
+{
+   int j;
    char mm, ff;
 
     DLOG(stderr,"compile arg1\n");
     // .END. or END
     if( strcasecmp( prefix, "END" ) == 0 ||
         strcasecmp( prefix, ".END." ) == 0 ) {
-        comp41_compile_end( code, comp41glo.global_count );
+        comp41_compile_end( code, unit->global_count );
 
         // set END flag
-        comp41glo.global_end = 1;
+        unit->global_end = 1;
         return( 3 );
     }
 
@@ -738,25 +1559,14 @@ int comp41_compile_arg1(unsigned char *code, char *prefix )
         return( 2 );
     }
 
-    // alternate-form functions
-    j = sizeof( alt_fcn1 ) / sizeof( FCN );
-    for( i = 0; i < j; ++ i ) {
-        if( strcasecmp( prefix, alt_fcn1[ i ].prefix ) == 0 ) {
-            code[ 0 ] = ( char )alt_fcn1[ i ].code;
-            return( 1 );
-        }
-    }
-
-    // single-byte functions
-    for( i = 0x40; i <= 0x8F; ++i ) {
-        if( strcasecmp( prefix, single20_8F[ i - 0x20 ] ) == 0 ) {
-            code[ 0 ] = i;
-            return( 1 );
-        }
+    // single-byte and alternate-form functions
+    if(( j = comp41_lookup( prefix, MN_FCN1 )) != -1 ) {
+        code[ 0 ] = j;
+        return( 1 );
     }
 
-    sprintf(comp41glo.err_msg, "Error: unrecognized or incomplete function[ %s ]\n", prefix );
-    comp41_print_error(comp41glo.err_msg);
+    sprintf(unit->err_msg, "Error: unrecognized or incomplete function[ %s ]\n", prefix );
+    comp41_print_error(unit,unit->err_msg);
     /*
     fprintf(stderr, "If [ %s ] is an external module function, try: [ XROM mm,ff ]\n",
             prefix );
@@ -765,9 +1575,9 @@ int comp41_compile_arg1(unsigned char *code, char *prefix )
 }
 
 
-int comp41_compile_arg2(unsigned char *code, char *prefix, char *postfix )
+int comp41_compile_arg2(COMP41_UNIT *unit, unsigned char *code, char *prefix, char *postfix )
 {
-   int i, j, k;
+   int i, j;
    long m, f;
    char mm, ff;
    char *pm, *pf, *stop;
@@ -819,32 +1629,13 @@ int comp41_compile_arg2(unsigned char *code, char *prefix, char *postfix )
         strcat( lbuffer, " " );
         strcat( lbuffer, ppostfix );
 
-        // LBL 00..14
-        for( i = 0x01; i <= 0x0F; ++i ) {
-            j = i - 0x01;
-            if( strcasecmp( lbuffer, single01_1C[ j ] ) == 0 ) {
-                code[ 0 ] = i;
-                return( 1 );
-            }
-        }
-
-        // RCL 00..15, STO 00..15
-        for( i = 0x20; i <= 0x3F; ++i ) {
-            j = i - 0x20;
-            if( strcasecmp( lbuffer, single20_8F[ j ] ) == 0 ) {
-                code[ 0 ] = i;
+        // LBL 00..14, RCL 00..15, STO 00..15, GTO 00..14
+        if(( i = comp41_lookup( lbuffer, MN_SHORT )) != -1 ) {
+            code[ 0 ] = i;
+            if( i < 0xB1 )
                 return( 1 );
-            }
-        }
-
-        // GTO 00..14
-        for( i = 0xB1; i <= 0xBF; ++i ) {
-            j = i - 0xB1;
-            if( strcasecmp( lbuffer, prefixB1_BF[ j ] ) == 0 ) {
-                code[ 0 ] = i;
-                code[ 1 ] = 0x00;
-                return( 2 );
-            }
+            code[ 1 ] = 0x00;
+            return( 2 );
         }
 
         //
@@ -857,44 +1648,12 @@ int comp41_compile_arg2(unsigned char *code, char *prefix, char *postfix )
             strcpy( lbuffer, prefix );
             strcat( lbuffer, " " );
 
-            // RCL __..TONE __
-            for( j = 0x90; j <= 0x9F; ++j ) {
-                k = j - 0x90;
-                if( strcasecmp( lbuffer, prefix90_9F[ k ] ) == 0 ) {
-                    code[ 0 ] = j;
-                    code[ 1 ] = i;
-                    return( 2 );
-                }
-            }
-
-            // SF __..FC? __
-            for( j = 0xA8; j <= 0xAD; ++j ) {
-                k = j - 0xA8;
-                if( strcasecmp( lbuffer, prefixA8_AD[ k ] ) == 0 ) {
-                    code[ 0 ] = j;
-                    code[ 1 ] = i;
-                    return( 2 );
-                }
-            }
-
-            // X<> __..LBL __
-            for( j = 0xCE; j <= 0xCF; ++j ) {
-                k = j - 0xCE;
-                if( strcasecmp( lbuffer, prefixCE_CF[ k ] ) == 0 ) {
-                    code[ 0 ] = j;
-                    code[ 1 ] = i;
-                    return( 2 );
-                }
-            }
-
-            // alternate-form functions
-            k = sizeof( alt_fcn2 ) / sizeof( FCN );
-            for( j = 0; j < k; ++ j ) {
-                if( strcasecmp( prefix, alt_fcn2[ j ].prefix ) == 0 ) {
-                    code[ 0 ] = ( char )alt_fcn2[ j ].code;
-                    code[ 1 ] = i;
-                    return( 2 );
-                }
+            // RCL __..TONE __, SF __..FC? __, X<> __..LBL __
+            if(( j = comp41_lookup( lbuffer, MN_PREFIX2 )) != -1 ||
+               ( j = comp41_lookup( prefix, MN_ALT2 )) != -1 ) {
+                code[ 0 ] = j;
+                code[ 1 ] = i;
+                return( 2 );
             }
 
             //
@@ -919,15 +1678,15 @@ int comp41_compile_arg2(unsigned char *code, char *prefix, char *postfix )
         }
     }
 
-    sprintf(comp41glo.err_msg, "Error: unrecognized function[ %s %s ]\n", prefix, postfix );
-    comp41_print_error(comp41glo.err_msg);
+    sprintf(unit->err_msg, "Error: unrecognized function[ %s %s ]\n", prefix, postfix );
+    comp41_print_error(unit,unit->err_msg);
     return( 0 );
 }
 
 
-int comp41_compile_arg3(unsigned char *code, char *prefix, char *ind, char *postfix )
+int comp41_compile_arg3(COMP41_UNIT *unit, unsigned char *code, char *prefix, char *ind, char *postfix )
 {
-   int i, j, k;
+   int i, j;
    char lbuffer[ MAX_LINE ];
    char num_postfix[] = "0#";
    char *ppostfix = postfix;
@@ -948,44 +1707,19 @@ int comp41_compile_arg3(unsigned char *code, char *prefix, char *ind, char *post
         strcpy( lbuffer, prefix );
         strcat( lbuffer, " " );
 
-        // RCL IND __..TONE IND __
-        for( j = 0x90; j <= 0x9F; ++j ) {
-            k = j - 0x90;
-            if( strcasecmp( lbuffer, prefix90_9F[ k ] ) == 0 ) {
-                code[ 0 ] = j;
-                code[ 1 ] = i + 0x80;
-                return( 2 );
-            }
-        }
-
-        // SF IND __..FC? IND __
-        for( j = 0xA8; j <= 0xAD; ++j ) {
-            k = j - 0xA8;
-            if( strcasecmp( lbuffer, prefixA8_AD[ k ] ) == 0 ) {
-                code[ 0 ] = j;
-                code[ 1 ] = i + 0x80;
-                return( 2 );
-            }
-        }
-
+        // RCL IND __..TONE IND __, SF IND __..FC? IND __,
         // X<> IND __..LBL IND __
-        for( j = 0xCE; j <= 0xCF; ++j ) {
-            k = j - 0xCE;
-            if( strcasecmp( lbuffer, prefixCE_CF[ k ] ) == 0 ) {
-                code[ 0 ] = j;
-                code[ 1 ] = i + 0x80;
-                return( 2 );
-            }
+        if(( j = comp41_lookup( lbuffer, MN_PREFIX2 )) != -1 ) {
+            code[ 0 ] = j;
+            code[ 1 ] = i + 0x80;
+            return( 2 );
         }
 
         // alternate-form IND functions
-        k = sizeof( alt_fcn2 ) / sizeof( FCN );
-        for( j = 0; j < k; ++ j ) {
-            if( strcasecmp( prefix, alt_fcn2[ j ].prefix ) == 0 ) {
-                code[ 0 ] = ( char )alt_fcn2[ j ].code;
-                code[ 1 ] = i;
-                return( 2 );
-            }
+        if(( j = comp41_lookup( prefix, MN_ALT2 )) != -1 ) {
+            code[ 0 ] = j;
+            code[ 1 ] = i;
+            return( 2 );
         }
 
         // GTO IND __
@@ -1004,14 +1738,14 @@ int comp41_compile_arg3(unsigned char *code, char *prefix, char *ind, char *post
         }
     }
 
-    sprintf(comp41glo.err_msg, "Error: unrecognized function[ %s %s %s ]\n",
+    sprintf(unit->err_msg, "Error: unrecognized function[ %s %s %s ]\n",
              prefix, ind, postfix );
-    comp41_print_error(comp41glo.err_msg);
+    comp41_print_error(unit,unit->err_msg);
     return( 0 );
 }
 
 
-int comp41_compile_label(unsigned char *code, char *label, char *alpha, int count, char *key )
+int comp41_compile_label(COMP41_UNIT *unit, unsigned char *code, char *label, char *alpha, int count, char *key )
 {
    int asn;
 
@@ -1027,14 +1761,18 @@ int comp41_compile_label(unsigned char *code, char *label, char *alpha, int coun
         return( count + 4 );
     }
 
-    if( count >= MAX_ALPHA )
-        sprintf(comp41glo.err_msg, "Error: alpha (global) postfix[ %s \"%s\" %s ] too long.\n",
+    if( count >= MAX_ALPHA ) {
+        sprintf(unit->err_msg, "Error: alpha (global) postfix[ %s \"%s\" %s ] too long.\n",
                  label, alpha, key );
-    else
-        sprintf(comp41glo.err_msg, "Error: invalid key assignment[ %s \"%s\" %s ]\n",
+        unit->error_column = unit->token_column[ 1 ];
+    }
+    else {
+        sprintf(unit->err_msg, "Error: invalid key assignment[ %s \"%s\" %s ]\n",
                  label, alpha, key );
+        unit->error_column = unit->token_column[ 2 ];
+    }
 
-    comp41_print_error(comp41glo.err_msg);
+    comp41_print_error(unit,unit->err_msg);
     return( 0 );
 }
 
@@ -1077,44 +1815,11 @@ void comp41_compile_end(unsigned char *code, int bytes )
 
 int comp41_is_postfix( char *postfix, int *pindex )
 {
-   int i, j;
-
-   for( i = 0; i <= 127; ++i ) {
-       if( strcmp( postfix, postfix00_7F[ i ] ) == 0 ) {
-           *pindex = i;
-           return( 1 );
-       }
-   }
-
-   // case-insensitive: "F..R"
-   for( i = 107; i <= 122; ++i ) {
-       if( strcasecmp( postfix, postfix00_7F[ i ] ) == 0 ) {
-           *pindex = i;
-           return( 1 );
-       }
-   }
-
-   for( i = 102, j = 0; i <= 111; ++i, ++j ) {
-       if( strcmp( postfix, alt_postfix102_111[ j ] ) == 0 ) {
-           *pindex = i;
-           return( 1 );
-       }
-   }
-
-   for( i = 117, j = 0; i <= 122; ++i, ++j ) {
-       if( strcmp( postfix, alt_postfix117_122[ j ] ) == 0 ) {
-           *pindex = i;
-           return( 1 );
-       }
-   }
+   int i;
 
-   if( strcmp( postfix, "~" ) == 0 ||
-       strcmp( postfix, ">" ) == 0 ||
-       strcmp( postfix, "|-" ) == 0 ||
-       strcmp( postfix, "\\-" ) == 0 ||
-       strcmp( postfix, ">-" ) == 0 ||
-       strcmp( postfix, "->" ) == 0 ) {
-       *pindex = 0x7A;
+   // "00".."101", "A".."e", case-insensitive "F..R" and alternate forms
+   if(( i = comp41_lookup( postfix, MN_POSTFIX )) != -1 ) {
+       *pindex = i;
        return( 1 );
    }
    return( 0 );
@@ -1130,22 +1835,29 @@ int comp41_UTFcmp( char *tbuffer, int len, int *utf)
    return(ret);
 }
 
-int comp41_parse_text( char *text, char *tbuffer, int *pcount )
+int comp41_parse_text( char *text, char *tbuffer, int k, int append, int *pcount )
 {
-   int i, j, k, n;
+   int i, j, n;
    int esc_x;
 
-    *pcount = 0;
-    k = (int) strlen( tbuffer );
-    DLOG(stderr,"parse text: %s %d\n",tbuffer,k);
-    if( k == 0 ) 
-        return( 1 );
+    // tbuffer is not terminated, k is the number of characters
+    DLOG(stderr,"parse text: %.*s %d\n",k,tbuffer,k);
+    i = j = n = 0;
 
+    // append text line: T"abc", >"abc"
+    if( append ) 
+        text[ n++ ] = 0x7F;
     // "~text"
-    if( tbuffer[ 0 ] == '~' )
-        tbuffer[ 0 ] = 0x7F;
+    else if( k && tbuffer[ 0 ] == '~' ) {
+        text[ n++ ] = 0x7F;
+        ++i;
+        --k;
+    }
+    text[ n ] = '\0';
+    *pcount = n;
+    if( k == 0 ) 
+        return( 1 );
 
-    i = j =  n = 0;
     do {
         --k;
 
@@ -1332,6 +2044,7 @@ int comp41_parse_text( char *text, char *tbuffer, int *pcount )
         ++i;
     } while( k );
 
+    text[ n ] = '\0';
     *pcount = n;
     DLOG(stderr,"parse text returns %d\n",n);
     return( n );
@@ -1344,7 +2057,7 @@ int comp41_is_inquotes(char *tbuffer )
 
     esc=0;
     if( tbuffer[ 0 ] == '\"' || tbuffer[ 0 ] == '\'' ) {
-        for( i=1; i<(int)strlen( tbuffer ); ++i ) {
+        for( i=1; tbuffer[ i ] != '\0'; ++i ) {
             if(tbuffer[i]== '\\') {
                if (esc) esc =0;
                else esc=1;
@@ -1465,92 +2178,61 @@ char comp41_get_xdigit( char xdigit )
 }
 
 
-int comp41_compile_args(unsigned char *code_buffer,
-                  int line_argc,
-                  char *line_argv[] )
+int comp41_compile_tokens( COMP41_UNIT *unit )
 {
-   static int fnumeric=0;
-   int base, size, count;
-   char lbuffer[ MAX_LINE ];
-   char num_buffer[ MAX_NUMERIC+1 ];
-   char text_buffer[ MAX_ALPHA+1 ];
-
-	base = 0;
-	if( comp41glo.line_numbers && isdigit( line_argv[ 0 ][ 0 ] )) {
-		line_argc -= 1;
-		base += 1;
-	}
-
-	count = 0;
-    if( line_argc == 1 ) {
-        if( comp41_get_numeric_prefix( num_buffer, line_argv[ base+0 ] )) {
-            if( fnumeric ) {
+   int i, count;
+   TOKEN *token;
+   LEXER *lexer = &unit->lexer;
+   unsigned char *code_buffer = unit->code_buffer;
+
+    count = 0;
+    token = lexer->token;
+    if( lexer->ntokens == 0 )
+        return( count );
+    for( i = 0; i < lexer->ntokens; ++i )
+        unit->token_column[ i ] = token[ i ].column;
+    unit->error_column = token[ 0 ].column;
+
+    if( lexer->ntokens == 1 ) {
+        if( token[ 0 ].type == TOK_NUMBER ) {
+            // separate consecutive numbers
+            if( unit->numeric_entry ) {
                 code_buffer[ 0 ] = '\0';
-                count = 1 + comp41_compile_num( &code_buffer[ 1 ], num_buffer );
+                count = 1 + comp41_compile_num( &code_buffer[ 1 ], token[ 0 ].text );
             }
             else {
-                fnumeric = 1;
-                count = comp41_compile_num( code_buffer, num_buffer );
+                unit->numeric_entry = 1;
+                count = comp41_compile_num( code_buffer, token[ 0 ].text );
             }
         }
         else {
-            fnumeric = 0;
-            if( comp41_get_text_prefix( text_buffer, line_argv[ base+0 ], &size )) {
-                count = comp41_compile_text( code_buffer, text_buffer, size );
+            unit->numeric_entry = 0;
+            if( token[ 0 ].type == TOK_TEXT ) {
+                count = comp41_compile_text( code_buffer, token[ 0 ].text, token[ 0 ].count );
             }
             else {
-                count = comp41_compile_arg1( code_buffer, line_argv[ base+0 ] );
+                count = comp41_compile_arg1( unit, code_buffer, token[ 0 ].word );
             }
         }
     }
-    else if( line_argc == 2 ) {
-        // make string copy
-        strcpy( lbuffer, line_argv[ base+0 ] );
-        strcat( lbuffer, line_argv[ base+1 ] );
-
-        if( comp41_get_numeric_prefix( num_buffer, lbuffer )) {
-            if( fnumeric ) {
-                code_buffer[ 0 ] = '\0';
-                count = 1 + comp41_compile_num( &code_buffer[ 1 ], num_buffer );
-            }
-            else {
-                fnumeric = 1;
-                count = comp41_compile_num( code_buffer, num_buffer );
-            }
+    else if( lexer->ntokens == 2 ) {
+        unit->numeric_entry = 0;
+        if( token[ 1 ].type == TOK_ALPHA ) {
+            count = comp41_compile_alpha( unit, code_buffer, token[ 0 ].word,
+                                   token[ 1 ].text, token[ 1 ].count );
         }
         else {
-            fnumeric = 0;
-            if( comp41_get_text_prefix( text_buffer, lbuffer, &size )) {
-                count = comp41_compile_text( code_buffer, text_buffer, size );
-            }
-            else if( comp41_get_alpha_postfix( text_buffer, line_argv[ base+1 ], &size )) {
-                count = comp41_compile_alpha( code_buffer, line_argv[ base+0 ],
-                                       text_buffer,size );
-            }
-            else {
-                count = comp41_compile_arg2( code_buffer, line_argv[ base+0 ],
-                                      line_argv[ base+1 ] );
-            }
+            count = comp41_compile_arg2( unit, code_buffer, token[ 0 ].word, token[ 1 ].word );
         }
     }
-    else if( line_argc == 3 ) {
-        if( comp41_get_alpha_postfix( text_buffer, line_argv[ base+1 ], &size )) {
-            count = comp41_compile_label( code_buffer, line_argv[ base+0 ],
-                                   text_buffer, size, line_argv[ base+2 ] );
+    else if( lexer->ntokens == 3 ) {
+        if( token[ 1 ].type == TOK_ALPHA ) {
+            count = comp41_compile_label( unit, code_buffer, token[ 0 ].word,
+                                   token[ 1 ].text, token[ 1 ].count, token[ 2 ].word );
         }
         else {
-            count = comp41_compile_arg3( code_buffer, line_argv[ base+0 ],
-                                  line_argv[ base+1 ], line_argv[ base+2 ] );
-        }
-    }
-    else if( line_argc == 4 ) {
-        // make string copy
-        strcpy( lbuffer, line_argv[ base+2 ] );
-        strcat( lbuffer, line_argv[ base+3 ] );
-
-        if( comp41_get_alpha_postfix( text_buffer, line_argv[ base+1 ], &size )) {
-            count = comp41_compile_label( code_buffer, line_argv[ base+0 ],
-                                   text_buffer, size, lbuffer );
+            count = comp41_compile_arg3( unit, code_buffer, token[ 0 ].word,
+                                  token[ 1 ].word, token[ 2 ].word );
         }
     }
 
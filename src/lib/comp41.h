@@ -184,20 +184,57 @@ char *alt_postfix117_122[] = {
    "^",      "_",      "`",
 };
 
-int comp41_get_line_args( char *line_argv[], char **line_ptr );
-int comp41_compile_args(unsigned char *code_buffer, int line_argc, char *line_argv[] );
+#define MAX_ARGS 5
+
+// tokens of a source line, see comp41_lex_line
+typedef enum {
+   TOK_WORD,     // mnemonic, postfix, IND or anything else
+   TOK_NUMBER,   // numeric entry, text is the normalized number
+   TOK_TEXT,     // text line: "abc", T"abc", >"abc" or T "abc"
+   TOK_ALPHA,    // quoted alpha postfix of LBL, GTO, XEQ, W or XROM
+   TOK_KEY,      // key assignment of a global label: Key:11 or Key: 11
+} TOKEN_TYPE;
+
+typedef struct {
+   int type;
+   int column;   // column in the source line, starting at 1
+   char *word;   // token as written in the source line
+   char *text;   // normalized number or decoded alpha characters
+   int count;    // number of alpha characters
+} TOKEN;
+
+// memory for the tokens of a line, reused for all lines of a compilation
+typedef struct {
+   char *mem;
+   size_t size;
+   size_t used;
+} ARENA;
+
+typedef struct {
+   ARENA arena;
+   int ntokens;
+   int more_column;   // column of the words beyond MAX_ARGS or 0
+   TOKEN token[ MAX_ARGS ];
+} LEXER;
+
+// state and options of the compilation of one source file, see comp41.c
+typedef struct comp41_unit COMP41_UNIT;
+
+int comp41_lex_line( COMP41_UNIT *unit, char *line );
+int comp41_lex_text( ARENA *arena, TOKEN *token, char *buffer );
+int comp41_lex_alpha( ARENA *arena, TOKEN *token );
+int comp41_compile_tokens( COMP41_UNIT *unit );
 int comp41_compile_num(unsigned char *code, char *num );
 int comp41_compile_text(unsigned char *code, char *text, int count );
-int comp41_compile_alpha(unsigned char *code, char *prefix, char *alpha, int count );
-int comp41_compile_arg1(unsigned char *code, char *prefix );
-int comp41_compile_arg2(unsigned char *code, char *prefix, char *postfix );
-int comp41_compile_arg3(unsigned char *code, char *prefix, char *pind, char *postfix );
-int comp41_compile_label(unsigned char *code, char *label, char *alpha, int count, char *key );
+int comp41_compile_alpha(COMP41_UNIT *unit, unsigned char *code, char *prefix, char *alpha, int count );
+void comp41_init_mnemonics( void );
+int comp41_compile_arg1(COMP41_UNIT *unit, unsigned char *code, char *prefix );
+int comp41_compile_arg2(COMP41_UNIT *unit, unsigned char *code, char *prefix, char *postfix );
+int comp41_compile_arg3(COMP41_UNIT *unit, unsigned char *code, char *prefix, char *pind, char *postfix );
+int comp41_compile_label(COMP41_UNIT *unit, unsigned char *code, char *label, char *alpha, int count, char *key );
 int comp41_get_numeric_prefix( char *numeric, char *buffer );
-int comp41_get_text_prefix( char *text, char *buffer, int *pcount );
-int comp41_get_alpha_postfix( char *alpha, char *buffer, int *size );
 int comp41_is_postfix( char *postfix, int *pindex );
-int comp41_parse_text( char *text, char *buffer, int *pcount );
+int comp41_parse_text( char *text, char *buffer, int len, int append, int *pcount );
 int comp41_is_inquotes( char *buffer );
 int comp41_is_append( char *prefix );
 int comp41_is_text( char *prefix );
@@ -0,0 +1,184 @@
+/* jump41.c -- compile the local jumps of HP41 programs */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* Local GTO and XEQ instructions contain the distance to their label.
+   The HP41 searches for the label when a jump is executed the first
+   time and stores the distance in the instruction ("compiled jump"),
+   following executions of the jump need no search. This file enters
+   the distances in advance:
+
+   2 byte GTO 00-14:    Bl        dbbbrrrr
+   3 byte GTO:          1101bbbr  rrrrrrrr  dlllllll
+   3 byte XEQ:          1110bbbr  rrrrrrrr  dlllllll
+
+   l is the label (B1 for label 0), r the number of registers and b the
+   number of bytes of the distance r*7+b from the first byte of the jump
+   to the first byte of the label. The direction bit d is set if the
+   label precedes the jump. Like the calculator, the label is searched
+   from the jump to the END of the program and then from the beginning
+   of the program.
+
+   The distance is zero if the label does not exist or is out of the
+   range of the instruction (111 bytes for a 2 byte GTO). Such a jump
+   is searched for by the calculator at run time.
+
+   A program that was read from a calculator may contain distances that
+   were compiled by the calculator. They are kept unless all distances
+   are recomputed, e.g. because the program was optimized. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lifutils.h"
+#include "jump41.h"
+
+#define DEBUG 0
+
+#define MAX_SHORT_REGS 0xf
+#define MAX_LONG_REGS 0x1ff
+
+struct jump41_label
+  {
+    int pc;     /* address of the label */
+    int label;  /* label number */
+  };
+
+int jump41_length(unsigned char *memory, int pc, int length)
+  {
+    unsigned char byte;
+
+    byte=memory[pc];
+    if(byte >= 0x1d && byte <= 0x1f)
+      {
+        /* alpha GTO, XEQ or W, see raw41lif_decode_alpha_gto */
+        if(pc+1 < length && (memory[pc+1]>>4)==0xf) return((memory[pc+1]&0xf)+2);
+        return(2);
+      }
+    if(byte < 0x90) return(1);
+    if(byte < 0xc0) return(2);
+    if(byte < 0xce)
+      {
+        /* global label or END */
+        if(pc+2 < length && (memory[pc+2]&0x80)) return((memory[pc+2]&0xf)+3);
+        return(3);
+      }
+    if(byte < 0xd0) return(2);
+    if(byte < 0xf0) return(3);
+    return((byte&0xf)+1);
+  }
+
+static int jump41_is_end(unsigned char *memory, int pc, int length)
+  {
+    return(memory[pc] >= 0xc0 && memory[pc] < 0xce && pc+2 < length &&
+           (memory[pc+2]&0x80)==0);
+  }
+
+static int jump41_find(struct jump41_label *labels, int num_labels, int pc, int label)
+  {
+    /* return the address of the label that a jump at pc reaches, -1 if
+       there is none */
+    int i;
+
+    for(i=0; i< num_labels; i++)
+      {
+        if(labels[i].pc > pc && labels[i].label == label) return(labels[i].pc);
+      }
+    for(i=0; i< num_labels; i++)
+      {
+        if(labels[i].pc >= pc) break;
+        if(labels[i].label == label) return(labels[i].pc);
+      }
+    return(-1);
+  }
+
+static int jump41_compiled(unsigned char *memory, int pc)
+  {
+    /* return 1 if the jump at pc contains a distance */
+    if(memory[pc] < 0xc0) return(memory[pc+1] != 0);
+    return((memory[pc]&0x0f) != 0 || memory[pc+1] != 0 || (memory[pc+2]&0x80) != 0);
+  }
+
+int jump41_compile(unsigned char *memory, int length, int all)
+  {
+    struct jump41_label *labels;
+    int num_labels, pc, n, end, target, distance, regs, bytes, direction;
+    int label, count;
+
+    labels=malloc((length+1)*sizeof(struct jump41_label));
+    if(labels == (struct jump41_label *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+
+    /* collect the local labels up to the END */
+    num_labels=0;
+    pc=0;
+    end=length;
+    while(pc < length)
+      {
+        n=jump41_length(memory,pc,length);
+        if(pc+n > length) break;
+        if(memory[pc] >= 0x01 && memory[pc] <= 0x0f)
+          {
+            labels[num_labels].pc=pc;
+            labels[num_labels++].label=memory[pc]-1;
+          }
+        else if(memory[pc] == 0xcf)
+          {
+            labels[num_labels].pc=pc;
+            labels[num_labels++].label=memory[pc+1];
+          }
+        else if(jump41_is_end(memory,pc,length))
+          {
+            end=pc+n;
+            break;
+          }
+        pc+=n;
+      }
+
+    /* enter the distances of the jumps */
+    count=0;
+    pc=0;
+    while(pc < end)
+      {
+        n=jump41_length(memory,pc,end);
+        if(pc+n > end) break;
+        if(((memory[pc] >= 0xb1 && memory[pc] <= 0xbf) || (memory[pc] >= 0xd0 && memory[pc] < 0xf0)) &&
+           (all || ! jump41_compiled(memory,pc)))
+          {
+            if(memory[pc] < 0xc0)
+              label=memory[pc]-0xb1;
+            else
+              label=memory[pc+2]&0x7f;
+            target=jump41_find(labels,num_labels,pc,label);
+            direction= target < pc;
+            distance= direction ? pc-target : target-pc;
+            regs=distance/7;
+            bytes=distance%7;
+            if(target == -1 || regs > (memory[pc] < 0xc0 ? MAX_SHORT_REGS : MAX_LONG_REGS))
+              {
+                regs=0;
+                bytes=0;
+                direction=0;
+              }
+            else
+              {
+                count++;
+              }
+            debug_print("jump at %d to label %d at %d: %d registers %d bytes\n",pc,label,target,regs,bytes);
+            if(memory[pc] < 0xc0)
+              {
+                memory[pc+1]=(direction<<7) | (bytes<<4) | regs;
+              }
+            else
+              {
+                memory[pc]=(memory[pc]&0xf0) | (bytes<<1) | (regs>>8);
+                memory[pc+1]=regs&0xff;
+                memory[pc+2]=(direction<<7) | label;
+              }
+          }
+        pc+=n;
+      }
+    free(labels);
+    return(count);
+  }
@@ -0,0 +1,12 @@
+/* jump41.h -- compile the local jumps of HP41 programs */
+/* 2026 J. Siebold, and placed under the GPL */
+
+int jump41_length(unsigned char *memory, int pc, int length);
+/* Return the number of bytes of the instruction at pc of a program with
+   length bytes */
+
+int jump41_compile(unsigned char *memory, int length, int all);
+/* Enter the jump distances of the short and long GTOs and local XEQs of
+   the program memory with length bytes. Jumps that already contain a
+   distance are only recomputed if all is set. Return the number of
+   compiled jumps */
@@ -0,0 +1,35 @@
+/* lif_backend.h -- interface between the generic block layer and the
+                    storage of a LIF medium */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#ifndef LIF_BACKEND_H
+#define LIF_BACKEND_H
+
+/* A backend is selected by a prefix of the file name given to lif_open,
+   e.g. "mem:disk.dat". The stream backend is selected by the file name
+   "-" for standard input/output. Errors are fatal except for open, which
+   returns -1. All functions get the descriptor returned by open */
+struct lif_backend
+  {
+    char *prefix;
+    int (*open)(char *name, int flags, int mode);
+    void (*close)(int fd);
+    void (*read)(int fd, int block, int count, unsigned char *data);
+    /* read count consecutive blocks */
+    void (*write)(int fd, int block, int count, unsigned char *data);
+    /* write count consecutive blocks */
+    void (*truncate)(int fd);
+    /* truncate the medium to zero length, may be a no-op */
+    void (*flush)(int fd);
+    /* write all data to the storage device */
+    int (*size)(int fd);
+    /* number of blocks, -1 if unknown */
+  };
+
+extern const struct lif_backend lif_file_backend;
+extern const struct lif_backend lif_phy_backend;
+extern const struct lif_backend lif_mem_backend;
+extern const struct lif_backend lif_stream_backend;
+extern const struct lif_backend lif_sim_backend;
+
+#endif
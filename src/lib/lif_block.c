@@ -6,77 +6,325 @@
 #include <errno.h>
 #include <string.h>
 #include <fcntl.h>
+#include "config.h"
 #include "lif_img.h"
 #include "lif_phy.h"
+#include "lif_journal.h"
+#include "lif_backend.h"
+#include "lif_stats.h"
+#include "lif_block.h"
 #include "lif_const.h"
 
 #define DEBUG 0
 #define debug_print(fmt, ...) \
             do { if (DEBUG) fprintf(stderr, fmt, __VA_ARGS__); } while (0)
 
-static int p_flag;
+/* The file backend is a thin layer above the image file functions.
 
-int lif_open(char * filename,int flags,int mode, int physical_flag)
+   Files and catalogs are read block by block. If a read continues the
+   previous one, the following blocks are read ahead into a buffer with
+   one system call. The read-ahead window starts with READAHEAD_MIN
+   blocks and doubles with every refill of a sequential run up to
+   READAHEAD_MAX blocks. The kernel is advised to fetch the next window
+   in the background. Any other access ends the run, writes and
+   truncation invalidate the buffer. */
+#define READAHEAD_MIN 4
+#define READAHEAD_MAX 64
+
+static unsigned char ra_buffer[READAHEAD_MAX*SECTOR_SIZE];
+static int ra_first;   /* first block in the buffer */
+static int ra_count=0; /* number of blocks in the buffer */
+static int ra_next= -1; /* block that continues a sequential run */
+static int ra_window;  /* current read-ahead window */
+
+static void lif_file_invalidate(void)
   {
-   int fileno;
+    ra_count=0;
+    ra_next= -1;
+  }
+
+static int lif_file_open(char *name, int flags, int mode)
+  {
+    lif_file_invalidate();
+    return(lif_open_img_file(name,flags,mode));
+  }
 
-   /* open file or device */
-   p_flag= physical_flag;
-   if (p_flag)
+static void lif_file_read(int fd, int block, int count, unsigned char *data)
+  {
+    int sequential, available;
+
+    sequential= block == ra_next;
+    ra_next= block+count;
+
+    /* serve the read from the read-ahead buffer */
+    if (block >= ra_first && block+count <= ra_first+ra_count)
       {
-        fileno=lif_open_phy_device(filename);
+        memcpy(data,ra_buffer+(block-ra_first)*SECTOR_SIZE,count*SECTOR_SIZE);
+        return;
+      }
+    if (! sequential)
+      {
+        ra_window=0;
       }
     else
       {
-        fileno=lif_open_img_file(filename,flags, mode);
+        ra_window= ra_window ? 2*ra_window : READAHEAD_MIN;
+        if (ra_window > READAHEAD_MAX) ra_window= READAHEAD_MAX;
+      }
+    if (count >= ra_window)
+      {
+        /* random access or large reads are not buffered */
+        if (count == 1) lif_read_img_block(fd,block,data);
+        else lif_read_img_blocks(fd,block,count,data);
+        return;
+      }
+
+    /* refill the buffer, never read beyond the end of the file */
+    available= lif_img_file_blocks(fd)-block;
+    ra_first= block;
+    ra_count= available < ra_window ? available : ra_window;
+    if (ra_count < count) ra_count= count;
+    debug_print("read ahead blocks %d..%d\n",ra_first,ra_first+ra_count-1);
+    lif_read_img_blocks(fd,ra_first,ra_count,ra_buffer);
+    lif_advise_img_file(fd,ra_first+ra_count,ra_window);
+    memcpy(data,ra_buffer,count*SECTOR_SIZE);
+  }
+
+static void lif_file_write(int fd, int block, int count, unsigned char *data)
+  {
+    lif_file_invalidate();
+    if (count == 1) lif_write_img_block(fd,block,data);
+    else lif_write_img_blocks(fd,block,count,data);
+  }
+
+static void lif_file_truncate(int fd)
+  {
+    lif_file_invalidate();
+    lif_truncate_img_file(fd);
+  }
+
+const struct lif_backend lif_file_backend=
+  {
+    "file:",
+    lif_file_open,
+    lif_close_img_file,
+    lif_file_read,
+    lif_file_write,
+    lif_file_truncate,
+    lif_sync_img_file,
+    lif_img_file_blocks
+  };
+
+/* The phy backend accesses a floppy disk sector by sector */
+static int lif_phy_open(char *name, int flags, int mode)
+  {
+    (void) flags;
+    (void) mode;
+    return(lif_open_phy_device(name));
+  }
+
+static void lif_phy_nop(int fd)
+  {
+    (void) fd;
+  }
+
+static int lif_phy_size(int fd)
+  {
+    (void) fd;
+    return(-1);
+  }
+
+const struct lif_backend lif_phy_backend=
+  {
+    "phy:",
+    lif_phy_open,
+    lif_close_phy_device,
+    lif_read_phy_blocks,
+    lif_write_phy_blocks,
+    lif_phy_nop,
+    lif_phy_nop,
+    lif_phy_size
+  };
+
+/* The sim backend accesses an image file through the physical disk
+   layer and a simulated drive */
+static int lif_sim_open(char *name, int flags, int mode)
+  {
+    (void) flags;
+    (void) mode;
+    return(lif_open_phy_controller(&lif_sim_controller,name));
+  }
+
+const struct lif_backend lif_sim_backend=
+  {
+    "sim:",
+    lif_sim_open,
+    lif_close_phy_device,
+    lif_read_phy_blocks,
+    lif_write_phy_blocks,
+    lif_phy_nop,
+    lif_phy_nop,
+    lif_phy_size
+  };
+
+/* backends that can be selected by a prefix of the file name */
+static const struct lif_backend *lif_backends[]=
+  {
+    &lif_file_backend,
+    &lif_phy_backend,
+    &lif_mem_backend,
+    &lif_sim_backend,
+    (struct lif_backend *) NULL
+  };
+
+/* backend of the open file or device */
+static const struct lif_backend *backend= &lif_file_backend;
+
+char *lif_image_name(char *filename)
+  {
+   int i;
+
+   /* strip the backend prefix, the file name of a floppy disk or of
+      standard input is no image file */
+   for (i=0; lif_backends[i] != (struct lif_backend *) NULL; i++)
+      {
+        if (strncmp(filename,lif_backends[i]->prefix,strlen(lif_backends[i]->prefix))==0)
+          {
+            if (lif_backends[i] == &lif_phy_backend) return((char *) NULL);
+            filename+=strlen(lif_backends[i]->prefix);
+            break;
+          }
+      }
+   if (strcmp(filename,lif_stream_backend.prefix)==0) return((char *) NULL);
+   return(filename);
+  }
+
+int lif_open(char * filename,int flags,int mode, int physical_flag)
+  {
+   int fileno, i;
+
+   /* select the backend, the -p option of the utilities selects the
+      phy backend. A file name without prefix is an image file */
+   backend= physical_flag ? &lif_phy_backend : &lif_file_backend;
+   for (i=0; lif_backends[i] != (struct lif_backend *) NULL; i++)
+      {
+        if (strncmp(filename,lif_backends[i]->prefix,strlen(lif_backends[i]->prefix))==0)
+          {
+            if (! physical_flag) backend= lif_backends[i];
+            filename+=strlen(lif_backends[i]->prefix);
+            break;
+          }
+      }
+
+   if (! physical_flag && strcmp(filename,lif_stream_backend.prefix)==0)
+      {
+        backend= &lif_stream_backend;
+      }
+
+   /* only the file backend uses the journal, any other access would
+      be overwritten when the journal is committed */
+   if (backend != &lif_file_backend && backend != &lif_stream_backend &&
+       lif_journal_exists(filename))
+      {
+        fprintf(stderr,"%s has a journal, access it as an image file\n",filename);
+        return(-1);
+      }
+
+   /* open file or device, an open transaction must see the truncation */
+   fileno=backend->open(filename,flags & ~O_TRUNC, mode);
+   if (fileno == -1) return(fileno);
+   if (backend == &lif_file_backend)
+      {
+        if (lif_journal_open(filename,fileno,(flags & O_ACCMODE) != O_RDONLY))
+          {
+            backend->close(fileno);
+            return(-1);
+          }
       }
-    return(fileno);
+   if (flags & O_TRUNC) lif_truncate(fileno);
+   return(fileno);
   }
 
 void lif_close(int fileno)
   {
    /* close file or device */
-   if (p_flag)
+   if (backend == &lif_file_backend)
       {
-        lif_close_phy_device(fileno);
+        lif_journal_close();
+        lif_file_invalidate();
+      }
+   backend->close(fileno);
+  }
+
+void lif_read_blocks(int input_file, int block, int count, unsigned char *data)
+  {
+   int i;
+
+   /* Read count consecutive blocks */
+   LIF_STATS_IO(0,block,count);
+   if (lif_journal_active())
+      {
+        for (i=0; i< count; i++) lif_journal_read_block(input_file,block+i,data+i*SECTOR_SIZE);
       }
     else
       {
-        lif_close_img_file(fileno);
+        backend->read(input_file,block,count,data);
       }
   }
 
 void lif_read_block(int input_file, int block, unsigned char *data)
   {
     /* Read one block */
-   if (p_flag)
+    lif_read_blocks(input_file,block,1,data);
+  }
+
+void lif_truncate(int fileno)
+  {
+   if (lif_journal_active())
       {
-        lif_read_phy_block(input_file,block,data);
+        lif_journal_truncate();
       }
     else
       {
-        lif_read_img_block(input_file,block,data);
+        backend->truncate(fileno);
       }
+  }
 
+void lif_flush(int fileno)
+  {
+   /* an open transaction is synchronized by its commit only */
+   if (! lif_journal_active()) backend->flush(fileno);
   }
 
-void lif_truncate(int fileno)
+int lif_num_blocks(int fileno)
   {
-   if (!p_flag) lif_truncate_img_file(fileno);
+   /* number of blocks of an image file, -1 for a physical device */
+   if (lif_journal_active()) return(lif_journal_num_blocks());
+   return(backend->size(fileno));
   }
 
-void lif_write_block(int output_file, int block, unsigned char *data)
+void lif_write_blocks(int output_file, int block, int count, unsigned char *data)
   {
-    /* Write one block */
-   if (p_flag)
+   int i;
+
+   /* Write count consecutive blocks */
+   LIF_STATS_IO(1,block,count);
+   if (lif_journal_active())
       {
-        lif_write_phy_block(output_file,block,data);
+        /* the image file changes when the transaction is committed */
+        lif_file_invalidate();
+        for (i=0; i< count; i++) lif_journal_write_block(block+i,data+i*SECTOR_SIZE);
       }
     else
       {
-        lif_write_img_block(output_file,block,data);
+        backend->write(output_file,block,count,data);
       }
+  }
 
+void lif_write_block(int output_file, int block, unsigned char *data)
+  {
+    /* Write one block */
+    lif_write_blocks(output_file,block,1,data);
   }
 
 
@@ -105,3 +353,59 @@ void lif_write_dir_entry(int output_file, int dir_start, int entry, unsigned cha
      lif_write_block(output_file,blocknum, block);
    }
 
+
+void lif_copy_to_fd(int input_file, int start, long length, int out_fd)
+  {
+    /* Copy length bytes starting at block start to descriptor out_fd */
+    unsigned char data[SECTOR_SIZE];
+    int n;
+
+    if (backend == &lif_file_backend && !lif_journal_active())
+      {
+        LIF_STATS_IO(0,start,(int) ((length+SECTOR_SIZE-1)/SECTOR_SIZE));
+        lif_copy_img_to_fd(input_file,start,length,out_fd);
+        return;
+      }
+    while(length > 0)
+      {
+        lif_read_block(input_file,start,data);
+        n= length > SECTOR_SIZE ? SECTOR_SIZE : (int) length;
+        if(write(out_fd,data,n) != n)
+          {
+            fprintf(stderr,"Error writing output file (%s)\n",strerror(errno));
+            exit(1);
+          }
+        length-=n;
+        start++;
+      }
+  }
+
+void lif_copy_from_fd(int in_fd, long in_off, int output_file, int start, int num_blocks)
+  {
+    /* Copy num_blocks complete blocks starting at offset in_off of descriptor
+       in_fd to block start */
+    unsigned char data[SECTOR_SIZE];
+    int i;
+
+    if (backend == &lif_file_backend && !lif_journal_active())
+      {
+        LIF_STATS_IO(1,start,num_blocks);
+        lif_file_invalidate();
+        lif_copy_fd_to_img(in_fd,in_off,output_file,start,(long) num_blocks*SECTOR_SIZE);
+        return;
+      }
+    if(lseek(in_fd,(off_t) in_off,SEEK_SET) == (off_t) -1)
+      {
+        fprintf(stderr,"Error seeking input file (%s)\n",strerror(errno));
+        exit(1);
+      }
+    for(i=0; i<num_blocks; i++)
+      {
+        if(read(in_fd,data,SECTOR_SIZE) != SECTOR_SIZE)
+          {
+            fprintf(stderr,"Error reading input file\n");
+            exit(1);
+          }
+        lif_write_block(output_file,start+i,data);
+      }
+  }
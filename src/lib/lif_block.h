@@ -1,14 +1,29 @@
 /* lif_block.c -- generic i/o layer for lif disk or image file */
 /*  2000, 2015 A. R. Duell, J. Siebold and placed under the GPL */
 int lif_open(char * filename,int flags,int mode, int physical);
-/* open a file or physical device */
+/* open a file or physical device. The backend is selected by a prefix
+   of filename: "file:" image file (default), "mem:" image file held in
+   memory, "phy:" floppy disk (same as physical set), "sim:" image file
+   accessed like a floppy disk in a simulated drive. The file name "-"
+   reads the image from standard input and writes it to standard output
+   on close if it was opened for writing */
+
+char *lif_image_name(char *filename);
+/* return the name of the image file without a backend prefix, NULL for
+   a floppy disk or standard input */
 
 void lif_close(int fileno);
 /* close a file or physical device */
 
-int lif_truncate(int fileno);
+void lif_truncate(int fileno);
 /* truncate a file to zero length (ingnored for physical devices) */
 
+void lif_flush(int fileno);
+/* write all data to the storage device */
+
+int lif_num_blocks(int fileno);
+/* get the number of blocks of an image file, -1 for physical devices */
+
 void lif_read_block(int input_device, int block, unsigned char *data);
 /* Read a block from fileno input_device.  block is the 
    number to read, data points to a 256 byte buffer to receive it */
@@ -16,6 +31,20 @@ void lif_read_block(int input_device, int block, unsigned char *data);
 void lif_write_block(int output_device, int block, unsigned char *data);
 /* write a file block */
 
+void lif_read_blocks(int input_device, int block, int count, unsigned char *data);
+/* read count consecutive blocks to a buffer of count*256 bytes */
+
+void lif_write_blocks(int output_device, int block, int count, unsigned char *data);
+/* write count consecutive blocks */
+
+void lif_copy_to_fd(int input_device, int start, long length, int out_fd);
+/* copy length bytes starting at block start to descriptor out_fd. Image
+   files are copied by the kernel if possible */
+
+void lif_copy_from_fd(int in_fd, long in_off, int output_device, int start, int num_blocks);
+/* copy num_blocks blocks starting at offset in_off of descriptor in_fd
+   to block start. Image files are copied by the kernel if possible */
+
 void lif_write_dir_entry(int output_device, int dir_start, int entry, unsigned char * dir_entry);
 /* write a directory entry */
 
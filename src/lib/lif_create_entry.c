@@ -5,62 +5,16 @@
 #include<ctype.h>
 #include<stdlib.h>
 #include<time.h>
+#include "lif_filetype.h"
 
 int get_filetype(char *type_string)
 /* Get the filetype code corresponding to the give file type string */
   {
-    struct ft 
-      {
-        char *name;
-        int code;
-      } filetype[] =
-      { 
-       {  "TEXT",   1 },
-        { "SDATA",  0xE0D0 },
-        { "DATA71", 0xE0F0 },
-        { "BIN71",  0xE204 },
-        { "LEX71",  0xE208 },
-        { "KEY71",  0xE20C },
-        { "BASIC71",0xE214 },
-        { "FORTH71",0xE218 },
-        { "WALL41", 0xE040 },
-        { "KEY41",  0xE050 },
-        { "STAT41", 0xE060 },
-        { "ROM41",  0xE070 },
-        { "PROG41", 0xE080 },
-        { "TEXT75", 0xE052 },
-        { "APPT75", 0xE053 },
-        { "LEX75",  0xE089 },
-        { "BASIC75",0xE088 },
-        { "ROM75",0xE08B },
-        { "",     0 }
-       };
-    char uc_ftype[11]; /* file type converted to upper case */
-    int i; /* loop index */
-    int type_code; /* File type code */
+    const struct lif_filetype *t;
 
-    /* convert input string to upper case */
-    i=0;
-    while((i<10) && (type_string[i]>' '))
-      {
-        uc_ftype[i]=toupper(type_string[i]);
-        i++;
-      }
-    uc_ftype[i]=0;
-
-    /* Search for matching filetype */
-    i=0;
-    type_code=-1; /* This will be made +ve when the file type is found */
-    while(strlen(filetype[i].name))
-      {
-        if(!strcmp(uc_ftype,filetype[i].name))
-          {
-            type_code=filetype[i].code;
-            break;
-          }
-        i++;
-      }
-    return(type_code);
+    t=lif_filetype_by_name(type_string);
+    if(t == (struct lif_filetype *) NULL) return(-1);
+    return(t->code);
   }
 
 void put_lif_int(unsigned char *data, int length, unsigned int value)
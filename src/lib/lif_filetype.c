@@ -0,0 +1,200 @@
+/* lif_filetype.c -- registry of known LIF file types */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* This table is the only place where LIF file type codes, their names
+   and the rules to get the file length from a directory entry are
+   defined. A type that comes in several variants (secure, private) has
+   one line per code. The first line of such a group is the code that is
+   used if a file of that type is created from its name. */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "lif_filetype.h"
+#include "lif_dir_utils.h"
+
+static const struct lif_filetype lif_filetypes[]=
+  {
+    /* HP71 types, from the HPIL interface owner's manual */
+    { 0x0001, "TEXT",   NULL,      LEN_BLOCKS,    "liftext" },
+    /* Secure text file -- The HPIL user manual and IDS volume 1 give
+       this as 0xE0D5. But the ROM listing in IDS volume 3 and thus the
+       machine itself gives 0xE0D1 */
+    { 0xE0D1, "TEXT",   NULL,      LEN_BLOCKS,    "liftext" },
+    { 0x00FF, "D-LEX71",NULL,      LEN_NYBBLES,   NULL },       /* disabled LEX */
+    { 0xE0D0, "SDATA",  NULL,      LEN_SDATA,     "sdata" },
+    { 0xE0F0, "DAT71",  "DATA71",  LEN_RECORDS,   NULL },
+    { 0xE0F1, "DAT71",  NULL,      LEN_RECORDS,   NULL },       /* secure */
+    { 0xE204, "BIN71",  NULL,      LEN_NYBBLES,   NULL },
+    { 0xE205, "BIN71",  NULL,      LEN_NYBBLES,   NULL },       /* secure */
+    { 0xE206, "BIN71",  NULL,      LEN_NYBBLES,   NULL },       /* private */
+    { 0xE207, "BIN71",  NULL,      LEN_NYBBLES,   NULL },       /* secure private */
+    { 0xE208, "LEX71",  NULL,      LEN_NYBBLES,   "lexcat71" },
+    { 0xE209, "LEX71",  NULL,      LEN_NYBBLES,   "lexcat71" }, /* secure */
+    { 0xE20A, "LEX71",  NULL,      LEN_NYBBLES,   "lexcat71" }, /* private */
+    { 0xE20B, "LEX71",  NULL,      LEN_NYBBLES,   "lexcat71" }, /* secure private */
+    { 0xE20C, "KEY71",  NULL,      LEN_NYBBLES,   NULL },
+    { 0xE20D, "KEY71",  NULL,      LEN_NYBBLES,   NULL },       /* secure */
+    { 0xE214, "BAS71",  "BASIC71", LEN_NYBBLES,   NULL },
+    { 0xE215, "BAS71",  NULL,      LEN_NYBBLES,   NULL },       /* secure */
+    { 0xE216, "BAS71",  NULL,      LEN_NYBBLES,   NULL },       /* private */
+    { 0xE217, "BAS71",  NULL,      LEN_NYBBLES,   NULL },       /* secure private */
+    { 0xE218, "FTH71",  "FORTH71", LEN_BLOCKS,    NULL },
+    { 0xE219, "FTH71",  NULL,      LEN_BLOCKS,    NULL },       /* secure */
+    { 0xE21A, "FTH71",  NULL,      LEN_BLOCKS,    NULL },       /* private */
+    { 0xE21B, "FTH71",  NULL,      LEN_BLOCKS,    NULL },       /* secure private */
+    { 0xE21C, "ROM71",  NULL,      LEN_NYBBLES,   NULL },
+    { 0xE222, "GRA71",  NULL,      LEN_NYBBLES,   NULL },
+    { 0xE224, "ADR71",  NULL,      LEN_NYBBLES,   NULL },       /* address file ?? */
+    { 0xE22E, "SYM71",  NULL,      LEN_NYBBLES,   NULL },       /* symbol file ?? */
+
+    /* HP41 types, from Synthetic Quick Reference Guide */
+    { 0xE020, "WAXM41", NULL,      LEN_REGISTERS, NULL },       /* WALL with X-MEM */
+    { 0xE030, "XM41",   NULL,      LEN_REGISTERS, NULL },       /* X-MEM */
+    { 0xE040, "ALL41",  "WALL41",  LEN_REGISTERS, "wall41" },
+    { 0xE050, "KEY41",  NULL,      LEN_REGISTERS, "key41" },
+    { 0xE060, "STAT41", NULL,      LEN_REGISTERS, "stat41" },
+    /* HP41 ROM/MLDL dump file, as used by MLDL-OS */
+    { 0xE070, "X-M41",  "ROM41",   LEN_REGISTERS, "er41rom" },
+    { 0xE080, "PGM41",  "PROG41",  LEN_BYTES,     "decomp41" },
+
+    /* HP75 types, from Synthetic Quick Reference Guide */
+    /* Little is known about these, so expect bugs! */
+    { 0xE052, "TXT75",  "TEXT75",  LEN_BLOCKS,    "liftext75" },
+    { 0xE053, "APP75",  "APPT75",  LEN_BLOCKS,    NULL },
+    { 0xE058, "DAT75",  NULL,      LEN_BLOCKS,    NULL },
+    { 0xE089, "LEX75",  NULL,      LEN_BLOCKS,    "lexcat75" },
+    { 0xE08A, "WKS75",  NULL,      LEN_BLOCKS,    NULL },       /* Visicalc */
+    { 0xE088, "BAS75",  "BASIC75", LEN_BLOCKS,    NULL },
+    /* HP75 BASIC (HP41 SQRG says it is, but never seen) */
+    { 0xE0FE, "BAS75",  NULL,      LEN_BLOCKS,    NULL },
+    { 0xE08B, "ROM75",  NULL,      LEN_BLOCKS,    NULL },       /* ROM-related file ? */
+  };
+
+#define NUM_FILETYPES ((int) (sizeof(lif_filetypes)/sizeof(struct lif_filetype)))
+
+/* Lookup indices, built on first use. code_index maps every possible type
+   code to its table position + 1 (0 = unknown type). name_index is an open
+   addressing hash table of table positions + 1, keyed on the upper case
+   type name or alias */
+#define NAME_INDEX_SIZE 256
+#define TYPE_NAME_LEN 10
+
+static unsigned char code_index[65536];
+static unsigned char name_index[NAME_INDEX_SIZE];
+static int index_built=0;
+
+static unsigned int lif_filetype_hash(char *name)
+  {
+    unsigned int h;
+
+    h=0;
+    while(*name)
+      {
+        h= h*31 + (unsigned char) toupper((unsigned char) *name);
+        name++;
+      }
+    return(h % NAME_INDEX_SIZE);
+  }
+
+static void lif_filetype_add_name(char *name, int i)
+  {
+    unsigned int h;
+
+    h=lif_filetype_hash(name);
+    while(name_index[h])
+      {
+        /* the first line of a group owns the name */
+        if(strcmp(lif_filetypes[name_index[h]-1].name,name)==0) return;
+        if(lif_filetypes[name_index[h]-1].alias != (char *) NULL &&
+           strcmp(lif_filetypes[name_index[h]-1].alias,name)==0) return;
+        h=(h+1) % NAME_INDEX_SIZE;
+      }
+    name_index[h]=i+1;
+  }
+
+static void lif_filetype_build_index(void)
+  {
+    int i;
+
+    for(i=0; i<NUM_FILETYPES; i++)
+      {
+        code_index[lif_filetypes[i].code]=i+1;
+        lif_filetype_add_name(lif_filetypes[i].name,i);
+        if(lif_filetypes[i].alias != (char *) NULL)
+          {
+            lif_filetype_add_name(lif_filetypes[i].alias,i);
+          }
+      }
+    index_built=1;
+  }
+
+const struct lif_filetype *lif_filetype_by_code(unsigned int code)
+  {
+    if(! index_built) lif_filetype_build_index();
+    if(code > 0xFFFF || code_index[code]==0) return((struct lif_filetype *) NULL);
+    return(&lif_filetypes[code_index[code]-1]);
+  }
+
+const struct lif_filetype *lif_filetype_by_name(char *name)
+  {
+    unsigned int h;
+    int i;
+    char uc_name[TYPE_NAME_LEN+1];
+    const struct lif_filetype *t;
+
+    if(! index_built) lif_filetype_build_index();
+
+    /* convert name to upper case */
+    i=0;
+    while((i<TYPE_NAME_LEN) && (name[i]>' '))
+      {
+        uc_name[i]=toupper((unsigned char) name[i]);
+        i++;
+      }
+    uc_name[i]=0;
+
+    h=lif_filetype_hash(uc_name);
+    while(name_index[h])
+      {
+        t= &lif_filetypes[name_index[h]-1];
+        if(strcmp(t->name,uc_name)==0) return(t);
+        if(t->alias != (char *) NULL && strcmp(t->alias,uc_name)==0) return(t);
+        h=(h+1) % NAME_INDEX_SIZE;
+      }
+    return((struct lif_filetype *) NULL);
+  }
+
+int lif_filetype_length(int length_rule, unsigned char *entry)
+  {
+    int length;
+
+    switch(length_rule)
+      {
+        case LEN_NYBBLES:
+          /* find length in nybbles and convert to bytes */
+          length=(*(entry+28)) +
+                 ((*(entry+29))<<8) +
+                 ((*(entry+30))<<16);
+          length=(length+1)/2;
+          break;
+        case LEN_SDATA:
+          length=get_lif_int(entry+28,2) * 8;
+          break;
+        case LEN_REGISTERS:
+          length=(get_lif_int(entry+28,2) * 8)+1;
+          break;
+        case LEN_BYTES:
+          length=get_lif_int(entry+28,2)+1;
+          break;
+        case LEN_RECORDS:
+          length=((*(entry+28)) + ((*(entry+29))<<8)) /* #records */
+                *((*(entry+30)) + ((*(entry+31))<<8)); /* record length */
+          break;
+        case LEN_BLOCKS:
+        default:
+          length=get_lif_int(entry+16,4) * 256;
+          break;
+      }
+    return(length);
+  }
@@ -0,0 +1,33 @@
+/* lif_filetype.h -- registry of known LIF file types */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#ifndef LIF_FILETYPE_H
+#define LIF_FILETYPE_H
+
+/* rules to compute the file length in bytes from a directory entry */
+#define LEN_BLOCKS    0  /* number of blocks * 256 (bytes 16..19) */
+#define LEN_NYBBLES   1  /* HP-71 length in nybbles (bytes 28..30, LSB first) */
+#define LEN_SDATA     2  /* number of registers * 8 (bytes 28..29) */
+#define LEN_REGISTERS 3  /* number of registers * 8 + 1 (bytes 28..29) */
+#define LEN_BYTES     4  /* number of bytes + 1 (bytes 28..29) */
+#define LEN_RECORDS   5  /* records * record length (bytes 28..31, LSB first) */
+
+struct lif_filetype
+  {
+    unsigned int code;  /* file type code of the directory entry */
+    char *name;         /* type name as displayed by lifdir */
+    char *alias;        /* alternative type name accepted on input or NULL */
+    int length_rule;    /* one of the LEN_* rules above */
+    char *decoder;      /* lifutils program to decode the raw file or NULL */
+  };
+
+const struct lif_filetype *lif_filetype_by_code(unsigned int code);
+/* Return the descriptor for a file type code or NULL if unknown */
+
+const struct lif_filetype *lif_filetype_by_name(char *name);
+/* Return the descriptor for a file type name (case insensitive) or NULL */
+
+int lif_filetype_length(int length_rule, unsigned char *entry);
+/* Compute the file length in bytes of a directory entry by length_rule */
+
+#endif
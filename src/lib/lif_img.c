@@ -2,29 +2,85 @@
                   a lif disk */ 
 /*  2000,2015 A. R. Duell, J. Siebold and placed under the GPL */
 
+#define _GNU_SOURCE
+#include "config.h"
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include "lif_const.h"
+#ifdef HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+#ifdef HAVE_FLOCK
+#include <sys/file.h>
+#endif
+#include "lif_img.h"
 
 #define DEBUG 0
+/* buffer size if data has to be copied in user space */
+#define COPY_BUFFER_SIZE 65536
 #define debug_print(fmt, ...) \
             do { if (DEBUG) fprintf(stderr, fmt, __VA_ARGS__); } while (0)
 
+/* Lock an image file or device against other processes. Readers share
+   the lock, writers get an exclusive one. flock() locks are used because
+   they are released on close and are understood by scripting languages
+   as well. The environment variable LIFUTILSLOCK selects the behaviour
+   if the file is locked: wait (default), nowait (fail at once) or off */
+int lif_lock_file(int fd, int exclusive, char *filename)
+  {
+#ifdef HAVE_FLOCK
+      char *lock_mode;
+      int op;
+
+      lock_mode=getenv("LIFUTILSLOCK");
+      if(lock_mode != (char *) NULL && strcmp(lock_mode,"off")==0) return(0);
+      op= exclusive ? LOCK_EX : LOCK_SH;
+      if(flock(fd,op | LOCK_NB)==0) return(0);
+
+      /* file systems without lock support are used unlocked */
+      if(errno != EWOULDBLOCK) return(0);
+      if(lock_mode != (char *) NULL && strcmp(lock_mode,"nowait")==0)
+        {
+          fprintf(stderr,"%s is in use by another process\n",filename);
+          return(-1);
+        }
+      fprintf(stderr,"Waiting for %s to be released by another process\n",filename);
+      while(flock(fd,op))
+        {
+          if(errno != EINTR)
+            {
+              fprintf(stderr,"Error locking %s (%s)\n",filename,strerror(errno));
+              return(-1);
+            }
+        }
+#endif
+      return(0);
+  }
+
 /* open lif image file */
 int lif_open_img_file(char *filename, int flags, int mode)
   {
       int iret;
 
-      iret=open(filename,flags,mode);
+      /* do not truncate the file before the lock is held */
+      iret=open(filename,flags & ~O_TRUNC,mode);
       /* the error handling is done by the caller, so output system error message only */
       if (iret== -1) 
         {
           fprintf(stderr,"%s\n",strerror(errno));
+          return(iret);
+        }
+      if (lif_lock_file(iret,(flags & O_ACCMODE) != O_RDONLY,filename))
+        {
+          close(iret);
+          return(-1);
         }
+      if (flags & O_TRUNC) lif_truncate_img_file(iret);
       return(iret);
   }
 /* close lif image file */
@@ -43,6 +99,42 @@ void lif_truncate_img_file(int lif_file)
        }
   }
 
+/* Flush an image file to the storage device */
+void lif_sync_img_file(int lif_file)
+  {
+      if(fsync(lif_file))
+       {
+          fprintf(stderr,"Error synchronizing file (%s)\n",strerror(errno));
+          exit(1);
+       }
+  }
+
+/* Tell the kernel that count blocks starting at block will be read soon */
+void lif_advise_img_file(int lif_file, int block, int count)
+  {
+#ifdef HAVE_POSIX_FADVISE
+      /* this is only a hint, errors are ignored */
+      (void) posix_fadvise(lif_file,(off_t) SECTOR_SIZE*block,(off_t) SECTOR_SIZE*count,POSIX_FADV_WILLNEED);
+#else
+      (void) lif_file;
+      (void) block;
+      (void) count;
+#endif
+  }
+
+/* Get the size of an image file in blocks */
+int lif_img_file_blocks(int lif_file)
+  {
+      struct stat st;
+
+      if(fstat(lif_file,&st))
+       {
+          fprintf(stderr,"Error getting file size (%s)\n",strerror(errno));
+          exit(1);
+       }
+      return((int) (st.st_size / SECTOR_SIZE));
+  }
+
 /* Read one block from an lif image file */
 void lif_read_img_block(int input_file, int block, unsigned char *data)
   {
@@ -99,3 +191,135 @@ void lif_write_img_block(int output_file, int block, unsigned char *data)
         exit(1);
       }
   }
+
+/* Read count consecutive blocks from an lif image file */
+void lif_read_img_blocks(int input_file, int block, int count, unsigned char *data)
+  {
+    off_t offset;
+    ssize_t read_ret;
+    size_t length;
+
+    offset=(off_t) SECTOR_SIZE*block;
+    length=(size_t) SECTOR_SIZE*count;
+    debug_print("read blocks %d..%d\n",block,block+count-1);
+    while(length > 0)
+      {
+        read_ret=pread(input_file,data,length,offset);
+        if (read_ret== (ssize_t) -1) 
+          {
+            if(errno == EINTR) continue;
+            fprintf(stderr,"Error reading block %d from file. (%s)\n",(int) (offset/SECTOR_SIZE),strerror(errno));
+            exit(1);
+          }
+        if (read_ret == 0) 
+          {
+            fprintf(stderr,"Premature end of sector %d.\n",(int) (offset/SECTOR_SIZE));
+            exit(1);
+          }
+        data+=read_ret;
+        offset+=read_ret;
+        length-=read_ret;
+      }
+  }
+
+/* Write count consecutive blocks to an lif image file */
+void lif_write_img_blocks(int output_file, int block, int count, unsigned char *data)
+  {
+    off_t offset;
+    ssize_t write_ret;
+    size_t length;
+
+    offset=(off_t) SECTOR_SIZE*block;
+    length=(size_t) SECTOR_SIZE*count;
+    debug_print("write blocks %d..%d\n",block,block+count-1);
+    while(length > 0)
+      {
+        write_ret=pwrite(output_file,data,length,offset);
+        if (write_ret == (ssize_t) -1)
+          {
+            if(errno == EINTR) continue;
+            fprintf(stderr,"Error writing block %d from file (%s)\n",(int) (offset/SECTOR_SIZE),strerror(errno));
+            exit(1);
+          }
+        data+=write_ret;
+        offset+=write_ret;
+        length-=write_ret;
+      }
+  }
+
+/* Copy length bytes between two descriptors. Data is read from offset
+   in_off of in_fd. If out_off is -1 the data is written to the current
+   file position of out_fd, otherwise at out_off. The kernel copies the
+   data with copy_file_range (which may share the extents on btrfs or xfs)
+   or sendfile. If neither is available for these descriptors the data is
+   copied using a large buffer. */
+static void lif_copy_range(int in_fd, off_t in_off, int out_fd, off_t out_off, long length)
+  {
+    unsigned char buffer[COPY_BUFFER_SIZE];
+    ssize_t n, w;
+    size_t chunk;
+
+    if(out_off != (off_t) -1)
+      {
+        if(lseek(out_fd,out_off,SEEK_SET) == (off_t) -1)
+          {
+            fprintf(stderr,"Error seeking to offset %ld. (%s)\n",(long) out_off,strerror(errno));
+            exit(1);
+          }
+      }
+#ifdef HAVE_COPY_FILE_RANGE
+    while(length > 0)
+      {
+        n=copy_file_range(in_fd,&in_off,out_fd,NULL,(size_t) length,0);
+        if(n <= 0) break;
+        debug_print("copy_file_range %ld bytes\n",(long) n);
+        length-=n;
+      }
+#endif
+#ifdef HAVE_SENDFILE
+    while(length > 0)
+      {
+        n=sendfile(out_fd,in_fd,&in_off,(size_t) length);
+        if(n <= 0) break;
+        debug_print("sendfile %ld bytes\n",(long) n);
+        length-=n;
+      }
+#endif
+    while(length > 0)
+      {
+        chunk= length > COPY_BUFFER_SIZE ? COPY_BUFFER_SIZE : (size_t) length;
+        n=pread(in_fd,buffer,chunk,in_off);
+        if(n == (ssize_t) -1)
+          {
+            fprintf(stderr,"Error reading at offset %ld. (%s)\n",(long) in_off,strerror(errno));
+            exit(1);
+          }
+        if(n == 0)
+          {
+            fprintf(stderr,"Premature end of file at offset %ld.\n",(long) in_off);
+            exit(1);
+          }
+        w=write(out_fd,buffer,n);
+        if(w != n)
+          {
+            fprintf(stderr,"Error writing %ld bytes. (%s)\n",(long) n,strerror(errno));
+            exit(1);
+          }
+        in_off+=n;
+        length-=n;
+      }
+  }
+
+/* Copy length bytes starting at block of an lif image file to the current
+   position of out_fd */
+void lif_copy_img_to_fd(int input_file, int block, long length, int out_fd)
+  {
+    lif_copy_range(input_file,(off_t) SECTOR_SIZE*block,out_fd,(off_t) -1,length);
+  }
+
+/* Copy length bytes starting at offset in_off of in_fd to block of an lif
+   image file */
+void lif_copy_fd_to_img(int in_fd, long in_off, int output_file, int block, long length)
+  {
+    lif_copy_range(in_fd,(off_t) in_off,output_file,(off_t) SECTOR_SIZE*block,length);
+  }
@@ -6,6 +6,10 @@ int lif_open_img_file(char * filename, int mode, int flag);
    mode is the mode in which it is opened and flag is 1 if filename
    is a device and 0 if filename is a file */
 
+int lif_lock_file(int fd, int exclusive, char *filename);
+/* lock an open image file or device, shared or exclusive. Return -1 if
+   the file is locked by another process and waiting was not requested */
+
 void lif_close_img_file(int fileno);
 /* Close the file or device indicated by descriptor */
 
@@ -17,8 +21,34 @@ void lif_write_img_block(int output_file, int block, unsigned char *data);
 /* write a file block to descriptor output_device.  block is the 
    number to write, data points to a 256 byte buffer  */
 
+void lif_read_img_blocks(int input_file, int block, int count, unsigned char *data);
+/* read count consecutive blocks starting at block with one system call
+   if possible */
+
+void lif_write_img_blocks(int output_file, int block, int count, unsigned char *data);
+/* write count consecutive blocks starting at block with one system call
+   if possible */
+
 void lif_truncate_img_file(int fileno);
 /* truncate an image file to zero length */
 
+void lif_sync_img_file(int fileno);
+/* flush an image file to the storage device */
+
+void lif_advise_img_file(int fileno, int block, int count);
+/* hint that count blocks starting at block will be read soon */
+
+int lif_img_file_blocks(int fileno);
+/* get the number of complete blocks of an image file */
+
+void lif_copy_img_to_fd(int input_file, int block, long length, int out_fd);
+/* Copy length bytes starting at block of an image file to the current
+   position of descriptor out_fd, without user space buffering if possible */
+
+void lif_copy_fd_to_img(int in_fd, long in_off, int output_file, int block, long length);
+/* Copy length bytes starting at offset in_off of descriptor in_fd to
+   block of an image file, without user space buffering if possible.
+   length should be a multiple of the block size */
+
 void exit_error(char *msg);
 /* exit and output error message */
@@ -5,6 +5,7 @@
 #include <windows.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <io.h>
 #include "lif_const.h"
 #include "lif_img.h"
 
@@ -29,7 +30,8 @@ int lif_open_img_file(char *filename, int flags, int mode)
      /* open files according to file open flags */
      if ((flags & 0x3) == O_RDONLY) 
        {
-          img_file_handle= CreateFile(filename, GENERIC_READ, 0, NULL, OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+          /* readers may share the file, writers need exclusive access */
+          img_file_handle= CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
        }
       if ((flags & 0x3) == O_RDWR)
        {
@@ -58,7 +60,44 @@ void lif_close_img_file(int descriptor)
       img_file_handle= (HANDLE) NULL;
   }
 
+/* flush the file to the storage device */
+void lif_advise_img_file(int lif_file, int block, int count)
+  {
+     /* not supported */
+  }
+
+void lif_sync_img_file(int lif_file)
+  {
+     if (img_file_handle== (HANDLE) NULL) 
+       {
+          fprintf(stderr,"Error: tried to synchronize a non existing file handle");
+          exit(1);
+       }
+     if (! FlushFileBuffers(img_file_handle))
+       {
+          exit_error("Error: synchronize LIF image file failed");
+       }
+  }
+
 /* truncate a file */
+int lif_img_file_blocks(int lif_file)
+  {
+    DWORD size;
+
+     if (img_file_handle== (HANDLE) NULL) 
+       {
+          fprintf(stderr,"Error: tried to get the size of a non existing file handle");
+          exit(1);
+       }
+     size=GetFileSize(img_file_handle,NULL);
+     if (size == INVALID_FILE_SIZE)
+       {
+          fprintf(stderr,"Error getting file size\n");
+          exit(1);
+       }
+     return((int) (size / SECTOR_SIZE));
+  }
+
 void lif_truncate_img_file(int lif_file)
   {
     DWORD seek_ret;
@@ -151,6 +190,77 @@ void lif_write_img_block(int output_file, int block, unsigned char *data)
           exit_error("Error: write to LIF image file failed");
        }
   }
+/* Read count consecutive blocks, block by block */
+void lif_read_img_blocks(int input_file, int block, int count, unsigned char *data)
+  {
+    int i;
+
+    for(i=0; i<count; i++)
+      {
+        lif_read_img_block(input_file,block+i,data+i*SECTOR_SIZE);
+      }
+  }
+
+/* Write count consecutive blocks, block by block */
+void lif_write_img_blocks(int output_file, int block, int count, unsigned char *data)
+  {
+    int i;
+
+    for(i=0; i<count; i++)
+      {
+        lif_write_img_block(output_file,block+i,data+i*SECTOR_SIZE);
+      }
+  }
+
+/* Copy length bytes starting at block of the image file to the current
+   position of out_fd. There is no kernel copy mechanism for a file handle
+   and a CRT descriptor, so copy block by block */
+void lif_copy_img_to_fd(int input_file, int block, long length, int out_fd)
+  {
+    unsigned char data[SECTOR_SIZE];
+    int n;
+
+    while(length > 0)
+      {
+        lif_read_img_block(input_file,block,data);
+        n= length > SECTOR_SIZE ? SECTOR_SIZE : (int) length;
+        if(_write(out_fd,data,n) != n)
+          {
+             fprintf(stderr,"Error: write to output file failed\n");
+             exit(1);
+          }
+        length-=n;
+        block++;
+      }
+  }
+
+/* Copy length bytes starting at offset in_off of in_fd to block of the
+   image file. A partial last block is filled with zeros */
+void lif_copy_fd_to_img(int in_fd, long in_off, int output_file, int block, long length)
+  {
+    unsigned char data[SECTOR_SIZE];
+    int i, n;
+
+    if(_lseek(in_fd,in_off,SEEK_SET) == -1L)
+      {
+         fprintf(stderr,"Error: seek in input file failed\n");
+         exit(1);
+      }
+    while(length > 0)
+      {
+        n= length > SECTOR_SIZE ? SECTOR_SIZE : (int) length;
+        if(_read(in_fd,data,n) != n)
+          {
+             fprintf(stderr,"Error: read from input file failed\n");
+             exit(1);
+          }
+        for(i=n; i<SECTOR_SIZE; i++) data[i]=0;
+        lif_write_img_block(output_file,block,data);
+        length-=n;
+        block++;
+      }
+  }
+
 void exit_error(char * msg)
 {
 	wchar_t buf[256];
@@ -0,0 +1,465 @@
+/* lif_journal.c -- journaled transactions on a LIF image file */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* While a transaction is open, all blocks written to an image file are
+   appended to the journal file IMAGEFILE.journal instead. The image file
+   itself is not touched, reads return the newest version of a block from
+   the journal. Thus any number of lifput, lifpurge, lifrename ...
+   invocations may be grouped into one transaction without synchronizing
+   anything. Only an open for writing uses an open transaction, readers
+   see the image file until the transaction is committed.
+
+   The transaction is committed by appending a commit record and
+   synchronizing the journal once. Then the journal is applied to the
+   image file, the image file is synchronized and the journal is removed.
+   The directory of the journal is synchronized after the journal was
+   created and removed, thus a crash never loses a committed journal nor
+   leaves a removed one behind. If this is interrupted, the next lif_open
+   of the image file applies the committed journal again. Replaying the journal is idempotent because it
+   only contains complete blocks and truncations.
+
+   Journal layout: a 16 byte header with the magic "LIFJNL01", followed by
+   records. Each record has a 12 byte header (type, argument, check) and
+   type JNL_BLOCK records are followed by the 256 bytes of the block. The
+   check of a record covers its header, its data and the check of the
+   previous record, so a torn record at the end of the journal and all
+   records behind it are ignored. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "config.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "lif_const.h"
+#include "lif_img.h"
+#include "lif_dir_utils.h"
+#include "lif_create_entry.h"
+#include "lif_journal.h"
+
+#define DEBUG 0
+#define debug_print(fmt, ...) \
+            do { if (DEBUG) fprintf(stderr, fmt, __VA_ARGS__); } while (0)
+
+#define JNL_MAGIC "LIFJNL01"
+#define JNL_HEADER_SIZE 16
+#define JNL_RECORD_SIZE 12
+
+/* record types */
+#define JNL_BLOCK 1     /* argument: block number, followed by data */
+#define JNL_TRUNCATE 2  /* truncate the image file to zero length */
+#define JNL_COMMIT 3    /* argument: number of preceding records */
+
+static FILE *jnl_file= (FILE *) NULL;
+static char *jnl_name= (char *) NULL;
+static int jnl_active=0;       /* journal overlays the image file */
+static int jnl_committed=0;    /* journal ends with a commit record */
+static int jnl_pending=0;      /* transaction open, not overlaid for a reader */
+static long *jnl_index= (long *) NULL; /* journal offset of each block */
+static int jnl_index_size=0;
+static long jnl_end;           /* offset behind the last valid record */
+static unsigned int jnl_check; /* check of the last valid record */
+static int jnl_records;        /* number of valid records */
+static int jnl_blocks;         /* number of block records */
+static int jnl_truncated;      /* image file was truncated */
+static int jnl_max_block;      /* highest block in the journal */
+static int jnl_base_blocks;    /* size of the image file */
+
+static unsigned int lif_journal_hash(unsigned int h, unsigned char *data, int length)
+  {
+    int i;
+
+    for(i=0; i<length; i++)
+      {
+        h= ((h << 5) | (h >> 27)) ^ data[i];
+        h= h*0x01000193;
+      }
+    return(h);
+  }
+
+static void lif_journal_error(char *action)
+  {
+    fprintf(stderr,"Error %s journal %s (%s)\n",action,jnl_name,strerror(errno));
+    exit(1);
+  }
+
+static void lif_journal_reset(void)
+  {
+    if(jnl_file != (FILE *) NULL) fclose(jnl_file);
+    jnl_file= (FILE *) NULL;
+    free(jnl_index);
+    jnl_index= (long *) NULL;
+    jnl_index_size=0;
+    jnl_active=0;
+    jnl_committed=0;
+    jnl_pending=0;
+    jnl_end=JNL_HEADER_SIZE;
+    jnl_check=0;
+    jnl_records=0;
+    jnl_blocks=0;
+    jnl_truncated=0;
+    jnl_max_block= -1;
+  }
+
+/* remember the journal offset of the newest version of block */
+static void lif_journal_index(int block, long offset)
+  {
+    int new_size;
+
+    if(block >= jnl_index_size)
+      {
+        new_size= jnl_index_size ? jnl_index_size : 256;
+        while(new_size <= block) new_size*=2;
+        jnl_index=realloc(jnl_index,new_size*sizeof(long));
+        if(jnl_index == (long *) NULL)
+          {
+            fprintf(stderr,"Cannot allocate memory\n");
+            exit(1);
+          }
+        memset(jnl_index+jnl_index_size,0,(new_size-jnl_index_size)*sizeof(long));
+        jnl_index_size=new_size;
+      }
+    jnl_index[block]=offset;
+    if(block > jnl_max_block) jnl_max_block=block;
+  }
+
+static void lif_journal_forget(void)
+  {
+    if(jnl_index_size) memset(jnl_index,0,jnl_index_size*sizeof(long));
+    jnl_truncated=1;
+    jnl_max_block= -1;
+  }
+
+static void lif_journal_append(int type, int arg, unsigned char *data)
+  {
+    unsigned char header[JNL_RECORD_SIZE];
+    unsigned int check;
+
+    put_lif_int(header,4,type);
+    put_lif_int(header+4,4,arg);
+    check=lif_journal_hash(jnl_check,header,8);
+    if(data != (unsigned char *) NULL) check=lif_journal_hash(check,data,SECTOR_SIZE);
+    put_lif_int(header+8,4,check);
+
+    if(fseek(jnl_file,jnl_end,SEEK_SET)) lif_journal_error("seeking");
+    if(fwrite(header,1,JNL_RECORD_SIZE,jnl_file) != JNL_RECORD_SIZE) lif_journal_error("writing");
+    if(data != (unsigned char *) NULL)
+      {
+        if(fwrite(data,1,SECTOR_SIZE,jnl_file) != SECTOR_SIZE) lif_journal_error("writing");
+      }
+    debug_print("journal record %d type %d arg %d at %ld\n",jnl_records,type,arg,jnl_end);
+    jnl_end+=JNL_RECORD_SIZE;
+    if(data != (unsigned char *) NULL) jnl_end+=SECTOR_SIZE;
+    jnl_check=check;
+    jnl_records++;
+  }
+
+/* Read the records of the journal, return 1 if it was committed */
+static int lif_journal_scan(void)
+  {
+    unsigned char header[JNL_RECORD_SIZE];
+    unsigned char data[SECTOR_SIZE];
+    unsigned int check;
+    int type, arg;
+
+    while(1)
+      {
+        if(fseek(jnl_file,jnl_end,SEEK_SET)) lif_journal_error("seeking");
+        if(fread(header,1,JNL_RECORD_SIZE,jnl_file) != JNL_RECORD_SIZE) break;
+        type=get_lif_int(header,4);
+        arg=get_lif_int(header+4,4);
+        check=lif_journal_hash(jnl_check,header,8);
+        if(type == JNL_BLOCK)
+          {
+            if(fread(data,1,SECTOR_SIZE,jnl_file) != SECTOR_SIZE) break;
+            check=lif_journal_hash(check,data,SECTOR_SIZE);
+          }
+        if(check != get_lif_int(header+8,4)) break;
+
+        switch(type)
+          {
+            case JNL_BLOCK:
+              lif_journal_index(arg,jnl_end+JNL_RECORD_SIZE);
+              jnl_blocks++;
+              jnl_end+=SECTOR_SIZE;
+              break;
+            case JNL_TRUNCATE:
+              lif_journal_forget();
+              break;
+            case JNL_COMMIT:
+              if(arg != jnl_records) return(0);
+              return(1);
+            default:
+              return(0);
+          }
+        jnl_end+=JNL_RECORD_SIZE;
+        jnl_check=check;
+        jnl_records++;
+      }
+    debug_print("journal has %d valid records\n",jnl_records);
+    return(0);
+  }
+
+static void lif_journal_sync(void)
+  {
+    if(fflush(jnl_file)) lif_journal_error("writing");
+#ifdef _WIN32
+    if(_commit(_fileno(jnl_file))) lif_journal_error("synchronizing");
+#else
+    if(fsync(fileno(jnl_file))) lif_journal_error("synchronizing");
+#endif
+  }
+
+/* Synchronize the directory that contains the journal, thus its creation
+   or removal is durable as well. Directories cannot be synchronized on
+   Windows and on some file systems, this is ignored */
+static void lif_journal_sync_dir(void)
+  {
+#ifndef _WIN32
+    char *dir, *p;
+    int fd;
+
+    dir=malloc(strlen(jnl_name)+2);
+    if(dir == (char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    strcpy(dir,jnl_name);
+    p=strrchr(dir,'/');
+    if(p == (char *) NULL) strcpy(dir,".");
+    else if(p == dir) dir[1]='\0';
+    else *p='\0';
+    fd=open(dir,O_RDONLY);
+    if(fd == -1)
+      {
+        free(dir);
+        lif_journal_error("opening the directory of");
+      }
+    if(fsync(fd) && errno != EINVAL && errno != EBADF)
+      {
+        close(fd);
+        free(dir);
+        lif_journal_error("synchronizing the directory of");
+      }
+    debug_print("directory %s synchronized\n",dir);
+    close(fd);
+    free(dir);
+#endif
+  }
+
+/* Write all records of a committed journal to the image file in their
+   original order and remove the journal */
+static void lif_journal_apply(int fd)
+  {
+    unsigned char header[JNL_RECORD_SIZE];
+    unsigned char data[SECTOR_SIZE];
+    int i, type, arg;
+
+    if(fseek(jnl_file,JNL_HEADER_SIZE,SEEK_SET)) lif_journal_error("seeking");
+    for(i=0; i<jnl_records; i++)
+      {
+        if(fread(header,1,JNL_RECORD_SIZE,jnl_file) != JNL_RECORD_SIZE) lif_journal_error("reading");
+        type=get_lif_int(header,4);
+        arg=get_lif_int(header+4,4);
+        if(type == JNL_BLOCK)
+          {
+            if(fread(data,1,SECTOR_SIZE,jnl_file) != SECTOR_SIZE) lif_journal_error("reading");
+            lif_write_img_block(fd,arg,data);
+          }
+        else if(type == JNL_TRUNCATE)
+          {
+            lif_truncate_img_file(fd);
+          }
+      }
+    lif_sync_img_file(fd);
+    fclose(jnl_file);
+    jnl_file= (FILE *) NULL;
+    if(remove(jnl_name)) lif_journal_error("removing");
+    lif_journal_sync_dir();
+    lif_journal_reset();
+  }
+
+int lif_journal_open(char *filename, int fd, int writable)
+  {
+    unsigned char header[JNL_HEADER_SIZE];
+
+    lif_journal_reset();
+    free(jnl_name);
+    jnl_name=malloc(strlen(filename)+9);
+    if(jnl_name == (char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    sprintf(jnl_name,"%s.journal",filename);
+    jnl_base_blocks=lif_img_file_blocks(fd);
+
+    jnl_file=fopen(jnl_name,writable ? "r+b" : "rb");
+    if(jnl_file == (FILE *) NULL)
+      {
+        if(errno == ENOENT) return(0);
+        fprintf(stderr,"Error opening journal %s (%s)\n",jnl_name,strerror(errno));
+        return(-1);
+      }
+    if(fread(header,1,JNL_HEADER_SIZE,jnl_file) != JNL_HEADER_SIZE ||
+       memcmp(header,JNL_MAGIC,strlen(JNL_MAGIC)) != 0)
+      {
+        fprintf(stderr,"%s is not a journal file\n",jnl_name);
+        lif_journal_reset();
+        return(-1);
+      }
+    jnl_committed=lif_journal_scan();
+    if(jnl_committed && writable)
+      {
+        fprintf(stderr,"Recovering committed transaction of %s\n",filename);
+        lif_journal_apply(fd);
+        return(0);
+      }
+    if(! jnl_committed && ! writable)
+      {
+        /* the transaction may still be aborted, readers see the image */
+        debug_print("%s\n","uncommitted journal ignored");
+        fclose(jnl_file);
+        jnl_file= (FILE *) NULL;
+        jnl_pending=1;
+        return(0);
+      }
+    jnl_active=1;
+    return(0);
+  }
+
+int lif_journal_exists(char *filename)
+  {
+    char *name;
+    FILE *fp;
+
+    name=malloc(strlen(filename)+9);
+    if(name == (char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    sprintf(name,"%s.journal",filename);
+    fp=fopen(name,"rb");
+    free(name);
+    if(fp == (FILE *) NULL) return(0);
+    fclose(fp);
+    return(1);
+  }
+
+int lif_journal_active(void)
+  {
+    return(jnl_active);
+  }
+
+int lif_journal_open_transaction(void)
+  {
+    return((jnl_active && ! jnl_committed) || jnl_pending);
+  }
+
+int lif_journal_committed(void)
+  {
+    return(jnl_active && jnl_committed);
+  }
+
+int lif_journal_blocks(void)
+  {
+    return(jnl_blocks);
+  }
+
+void lif_journal_close(void)
+  {
+    lif_journal_reset();
+  }
+
+void lif_journal_read_block(int fd, int block, unsigned char *data)
+  {
+    if(block < jnl_index_size && jnl_index[block] != 0)
+      {
+        debug_print("read block %d from journal\n",block);
+        if(fseek(jnl_file,jnl_index[block],SEEK_SET)) lif_journal_error("seeking");
+        if(fread(data,1,SECTOR_SIZE,jnl_file) != SECTOR_SIZE) lif_journal_error("reading");
+        return;
+      }
+    if(! jnl_truncated && block < jnl_base_blocks)
+      {
+        lif_read_img_block(fd,block,data);
+        return;
+      }
+    /* blocks in front of the last written block read as zeros, like a
+       hole in a file */
+    if(block > jnl_max_block)
+      {
+        fprintf(stderr,"Premature end of sector %d.\n",block);
+        exit(1);
+      }
+    memset(data,0,SECTOR_SIZE);
+  }
+
+void lif_journal_write_block(int block, unsigned char *data)
+  {
+    long offset;
+
+    offset=jnl_end+JNL_RECORD_SIZE;
+    lif_journal_append(JNL_BLOCK,block,data);
+    lif_journal_index(block,offset);
+    jnl_blocks++;
+  }
+
+void lif_journal_truncate(void)
+  {
+    lif_journal_append(JNL_TRUNCATE,0,(unsigned char *) NULL);
+    lif_journal_forget();
+  }
+
+int lif_journal_num_blocks(void)
+  {
+    int n;
+
+    n= jnl_truncated ? 0 : jnl_base_blocks;
+    if(jnl_max_block+1 > n) n=jnl_max_block+1;
+    return(n);
+  }
+
+int lif_journal_begin(void)
+  {
+    unsigned char header[JNL_HEADER_SIZE];
+
+    if(jnl_active) return(-1);
+    jnl_file=fopen(jnl_name,"w+b");
+    if(jnl_file == (FILE *) NULL) lif_journal_error("creating");
+    memset(header,0,JNL_HEADER_SIZE);
+    memcpy(header,JNL_MAGIC,strlen(JNL_MAGIC));
+    if(fwrite(header,1,JNL_HEADER_SIZE,jnl_file) != JNL_HEADER_SIZE) lif_journal_error("writing");
+    lif_journal_sync_dir();
+    jnl_active=1;
+    return(0);
+  }
+
+int lif_journal_commit(int fd, int apply)
+  {
+    if(! jnl_active || jnl_committed) return(-1);
+    lif_journal_append(JNL_COMMIT,jnl_records,(unsigned char *) NULL);
+    /* this is the commit point */
+    lif_journal_sync();
+    jnl_committed=1;
+    if(apply) lif_journal_apply(fd);
+    return(0);
+  }
+
+int lif_journal_abort(void)
+  {
+    if(! jnl_active) return(-1);
+    fclose(jnl_file);
+    jnl_file= (FILE *) NULL;
+    if(remove(jnl_name)) lif_journal_error("removing");
+    lif_journal_sync_dir();
+    lif_journal_reset();
+    return(0);
+  }
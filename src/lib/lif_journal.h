@@ -0,0 +1,55 @@
+/* lif_journal.h -- journaled transactions on a LIF image file */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#ifndef LIF_JOURNAL_H
+#define LIF_JOURNAL_H
+
+int lif_journal_open(char *filename, int fd, int writable);
+/* Look for the journal of the image file filename which is open as fd.
+   A committed transaction is applied to the image if writable is set.
+   An open transaction is only overlaid if writable is set, readers see
+   the image until it is committed. Return -1 if the journal is invalid */
+
+int lif_journal_exists(char *filename);
+/* return 1 if the image file filename has a journal */
+
+int lif_journal_active(void);
+/* return 1 if block i/o goes through the journal */
+
+int lif_journal_open_transaction(void);
+/* return 1 if the image opened last has an open transaction */
+
+int lif_journal_committed(void);
+/* return 1 if a committed transaction was not yet applied to the image */
+
+int lif_journal_blocks(void);
+/* return the number of blocks written by the open transaction */
+
+void lif_journal_close(void);
+/* close the journal, nothing is synchronized */
+
+void lif_journal_read_block(int fd, int block, unsigned char *data);
+/* read a block of the image as modified by the journal */
+
+void lif_journal_write_block(int block, unsigned char *data);
+/* append a block to the journal */
+
+void lif_journal_truncate(void);
+/* append a truncation of the image to the journal */
+
+int lif_journal_num_blocks(void);
+/* get the number of blocks of the image as modified by the journal */
+
+int lif_journal_begin(void);
+/* start a transaction on the image opened last.
+   Return -1 if a transaction is already open */
+
+int lif_journal_commit(int fd, int apply);
+/* commit the open transaction with one synchronization of the journal
+   and apply it to the image if apply is set, otherwise the next lif_open
+   for writing applies it. Return -1 if no transaction is open */
+
+int lif_journal_abort(void);
+/* discard the open transaction. Return -1 if no transaction is open */
+
+#endif
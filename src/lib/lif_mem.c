@@ -0,0 +1,262 @@
+/* lif_mem.c -- RAM resident LIF image file */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* The "mem:" backend reads the whole image file into memory when it is
+   opened. All block i/o is done in memory, only the modified blocks are
+   written back when the image file is closed. The image file stays open
+   (and locked) in between. Like the image file layer, only one image file
+   can be open at any time.
+
+   The stream backend uses the same memory image for an image file that
+   is read from standard input (file name "-"). If it is opened read
+   only, standard input is read on demand up to the highest block that
+   was requested. Otherwise the whole image is read when it is opened and
+   the modified image is written to standard output when it is closed. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <limits.h>
+#include "config.h"
+#include "lif_const.h"
+#include "lif_img.h"
+#include "lif_backend.h"
+
+#define DEBUG 0
+#define debug_print(fmt, ...) \
+            do { if (DEBUG) fprintf(stderr, fmt, __VA_ARGS__); } while (0)
+
+static unsigned char *mem_data= (unsigned char *) NULL; /* image data */
+static unsigned char *mem_dirty= (unsigned char *) NULL; /* modified blocks */
+static int mem_blocks=0;     /* size of the image in blocks */
+static int mem_allocated=0;  /* allocated blocks */
+static int mem_truncated=0;  /* image was truncated */
+static long stream_bytes=0;  /* bytes read from standard input */
+static int stream_eof=0;     /* end of standard input reached */
+static int stream_writable=0; /* write image to standard output on close */
+
+/* number of blocks read from standard input at once */
+#define STREAM_CHUNK 64
+
+static void lif_mem_grow(int blocks)
+  {
+    /* make room for blocks blocks, new blocks read as zeros */
+    int new_size;
+
+    if(blocks <= mem_allocated) return;
+    new_size= mem_allocated ? mem_allocated : 64;
+    while(new_size < blocks) new_size*=2;
+    mem_data=realloc(mem_data,(size_t) new_size*SECTOR_SIZE);
+    mem_dirty=realloc(mem_dirty,(size_t) new_size);
+    if(mem_data == (unsigned char *) NULL || mem_dirty == (unsigned char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    memset(mem_data+(size_t) mem_allocated*SECTOR_SIZE,0,(size_t) (new_size-mem_allocated)*SECTOR_SIZE);
+    memset(mem_dirty+mem_allocated,0,new_size-mem_allocated);
+    mem_allocated=new_size;
+  }
+
+static void lif_mem_write_back(int fd)
+  {
+    /* write all modified blocks to the image file, consecutive blocks
+       with one call */
+    int i, first;
+
+    if(mem_truncated)
+      {
+        lif_truncate_img_file(fd);
+        mem_truncated=0;
+        if(mem_blocks) memset(mem_dirty,1,mem_blocks);
+      }
+    i=0;
+    while(i < mem_blocks)
+      {
+        if(! mem_dirty[i])
+          {
+            i++;
+            continue;
+          }
+        first=i;
+        while(i < mem_blocks && mem_dirty[i]) mem_dirty[i++]=0;
+        debug_print("write back blocks %d..%d\n",first,i-1);
+        lif_write_img_blocks(fd,first,i-first,mem_data+(size_t) first*SECTOR_SIZE);
+      }
+  }
+
+static int lif_mem_open(char *name, int flags, int mode)
+  {
+    int fd;
+
+    fd=lif_open_img_file(name,flags,mode);
+    if(fd == -1) return(fd);
+    mem_blocks=0;
+    mem_truncated=0;
+    if((flags & 0x3) != O_WRONLY)
+      {
+        mem_blocks=lif_img_file_blocks(fd);
+        lif_mem_grow(mem_blocks);
+        if(mem_blocks) lif_read_img_blocks(fd,0,mem_blocks,mem_data);
+      }
+    debug_print("loaded %d blocks\n",mem_blocks);
+    return(fd);
+  }
+
+static void lif_mem_close(int fd)
+  {
+    lif_mem_write_back(fd);
+    lif_close_img_file(fd);
+    free(mem_data);
+    free(mem_dirty);
+    mem_data= (unsigned char *) NULL;
+    mem_dirty= (unsigned char *) NULL;
+    mem_allocated=0;
+    mem_blocks=0;
+  }
+
+static void lif_mem_read(int fd, int block, int count, unsigned char *data)
+  {
+    (void) fd;
+    if(block+count > mem_blocks)
+      {
+        fprintf(stderr,"Premature end of sector %d.\n",mem_blocks > block ? mem_blocks : block);
+        exit(1);
+      }
+    memcpy(data,mem_data+(size_t) block*SECTOR_SIZE,(size_t) count*SECTOR_SIZE);
+  }
+
+static void lif_mem_write(int fd, int block, int count, unsigned char *data)
+  {
+    (void) fd;
+    lif_mem_grow(block+count);
+    memcpy(mem_data+(size_t) block*SECTOR_SIZE,data,(size_t) count*SECTOR_SIZE);
+    memset(mem_dirty+block,1,count);
+    if(block+count > mem_blocks) mem_blocks=block+count;
+  }
+
+static void lif_mem_truncate(int fd)
+  {
+    (void) fd;
+    if(mem_allocated)
+      {
+        memset(mem_data,0,(size_t) mem_allocated*SECTOR_SIZE);
+        memset(mem_dirty,0,mem_allocated);
+      }
+    mem_blocks=0;
+    mem_truncated=1;
+  }
+
+static void lif_mem_flush(int fd)
+  {
+    lif_mem_write_back(fd);
+    lif_sync_img_file(fd);
+  }
+
+static int lif_mem_size(int fd)
+  {
+    (void) fd;
+    return(mem_blocks);
+  }
+
+const struct lif_backend lif_mem_backend=
+  {
+    "mem:",
+    lif_mem_open,
+    lif_mem_close,
+    lif_mem_read,
+    lif_mem_write,
+    lif_mem_truncate,
+    lif_mem_flush,
+    lif_mem_size
+  };
+
+static void lif_stream_fill(int blocks)
+  {
+    /* read standard input until blocks blocks are available */
+    size_t n;
+
+    while(mem_blocks < blocks && ! stream_eof)
+      {
+        lif_mem_grow((int) (stream_bytes/SECTOR_SIZE)+STREAM_CHUNK);
+        n=fread(mem_data+stream_bytes,1,(size_t) mem_allocated*SECTOR_SIZE-stream_bytes,stdin);
+        if(n == 0)
+          {
+            if(ferror(stdin))
+              {
+                fprintf(stderr,"Error reading standard input\n");
+                exit(1);
+              }
+            stream_eof=1;
+          }
+        stream_bytes+=n;
+        mem_blocks=(int) (stream_bytes/SECTOR_SIZE);
+      }
+    debug_print("%d blocks read from standard input\n",mem_blocks);
+  }
+
+static int lif_stream_open(char *name, int flags, int mode)
+  {
+    (void) name;
+    (void) mode;
+    SETMODE_STDIN_BINARY;
+    mem_blocks=0;
+    stream_bytes=0;
+    stream_eof=0;
+    stream_writable= (flags & 0x3) != O_RDONLY;
+    /* a new image is not read from standard input */
+    if((flags & 0x3) == O_WRONLY) stream_eof=1;
+    if(stream_writable) lif_stream_fill(INT_MAX);
+    return(_fileno(stdin));
+  }
+
+static void lif_stream_close(int fd)
+  {
+    (void) fd;
+    if(stream_writable)
+      {
+        SETMODE_STDOUT_BINARY;
+        if(fwrite(mem_data,SECTOR_SIZE,mem_blocks,stdout) != (size_t) mem_blocks || fflush(stdout))
+          {
+            fprintf(stderr,"Error writing standard output\n");
+            exit(1);
+          }
+      }
+    free(mem_data);
+    free(mem_dirty);
+    mem_data= (unsigned char *) NULL;
+    mem_dirty= (unsigned char *) NULL;
+    mem_allocated=0;
+    mem_blocks=0;
+  }
+
+static void lif_stream_read(int fd, int block, int count, unsigned char *data)
+  {
+    lif_stream_fill(block+count);
+    lif_mem_read(fd,block,count,data);
+  }
+
+static void lif_stream_flush(int fd)
+  {
+    (void) fd;
+  }
+
+static int lif_stream_size(int fd)
+  {
+    (void) fd;
+    lif_stream_fill(INT_MAX);
+    return(mem_blocks);
+  }
+
+const struct lif_backend lif_stream_backend=
+  {
+    "-",
+    lif_stream_open,
+    lif_stream_close,
+    lif_stream_read,
+    lif_mem_write,
+    lif_mem_truncate,
+    lif_stream_flush,
+    lif_stream_size
+  };
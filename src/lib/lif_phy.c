@@ -0,0 +1,189 @@
+/* lif_phy.c -- block i/o on physical LIF disks */
+/* 2026 J. Siebold and placed under the GPL */
+
+/* This file maps logical blocks to the sectors of a LIF disk and issues
+   the commands of a disk controller (see lif_phy_linux.c for the PC
+   floppy disk controller and lif_phy_sim.c for the simulated drive).
+
+   Block n is located on cylinder n/32, head (n/16)%2, sector (n%16)+1.
+   A controller command transfers as many sectors of one track as
+   possible. Reading a single sector costs nearly a full revolution of
+   the disk, so a read always fetches the whole track and keeps it in a
+   track cache. Following reads of blocks on the same track need no
+   access to the disk. If one sector of a track is unreadable, the whole
+   track read fails. Such a track is not cached, its blocks are read one
+   by one as requested, thus only a read of the bad sector fails. Writes
+   go to the disk immediately and update the track cache. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lif_phy.h"
+#include "lif_const.h"
+
+#define DEBUG 0
+#define debug_print(fmt, ...) \
+            do { if (DEBUG) fprintf(stderr, fmt, __VA_ARGS__); } while (0)
+
+static const struct lif_phy_controller *controller= &lif_fdc_controller;
+static int current_cylinder;
+static unsigned char *track_cache[PHY_TRACKS]; /* NULL if not cached */
+static char track_failed[PHY_TRACKS]; /* the track could not be read */
+
+int lif_open_phy_controller(const struct lif_phy_controller *ctl, char *name)
+  {
+    int device, i;
+
+    device=ctl->open(name);
+    if(device != -1)
+      {
+        controller=ctl;
+        for(i=0; i< PHY_TRACKS; i++)
+          {
+            track_cache[i]= (unsigned char *) NULL;
+            track_failed[i]=0;
+          }
+        /* Move the drive head to cylinder 0 and set current_cylinder */
+        controller->recalibrate(device);
+        current_cylinder=0;
+      }
+    return(device);
+  }
+
+int lif_open_phy_device(char * devicename)
+  {
+    return(lif_open_phy_controller(&lif_fdc_controller,devicename));
+  }
+
+void lif_close_phy_device(int descriptor)
+  {
+    int i;
+
+    for(i=0; i< PHY_TRACKS; i++)
+      {
+        free(track_cache[i]);
+        track_cache[i]= (unsigned char *) NULL;
+      }
+    controller->close(descriptor);
+  }
+
+static void lif_phy_seek(int device, int cylinder)
+  {
+    /* If we're not on the right cylinder, go there */
+    if(cylinder!=current_cylinder)
+      {
+        controller->seek(device,cylinder);
+        current_cylinder=cylinder;
+      }
+  }
+
+static unsigned char *lif_phy_track(int device, int track)
+  {
+    /* get a track from the cache, read it if it is not cached. Returns
+       NULL for tracks beyond the disk geometry and for tracks that could
+       not be read completely */
+    unsigned char *data;
+
+    if(track >= PHY_TRACKS || track_failed[track]) return((unsigned char *) NULL);
+    if(track_cache[track] == (unsigned char *) NULL)
+      {
+        data=malloc(PHY_SECTORS*SECTOR_SIZE);
+        if(data == (unsigned char *) NULL)
+          {
+            fprintf(stderr,"Cannot allocate memory\n");
+            exit(1);
+          }
+        debug_print("read track %d\n",track);
+        lif_phy_seek(device,track/PHY_HEADS);
+        if(controller->read(device,track/PHY_HEADS,track%PHY_HEADS,1,PHY_SECTORS,data) != 0)
+          {
+            debug_print("track %d not readable\n",track);
+            free(data);
+            track_failed[track]=1;
+            return((unsigned char *) NULL);
+          }
+        track_cache[track]=data;
+      }
+    return(track_cache[track]);
+  }
+
+static void lif_phy_read_sector(int device, int track, int sector, unsigned char *data)
+  {
+    /* read one sector, sectors are numbered from 1 */
+    lif_phy_seek(device,track/PHY_HEADS);
+    if(controller->read(device,track/PHY_HEADS,track%PHY_HEADS,sector,1,data) != 0)
+      {
+        fprintf(stderr,"Error reading cylinder %d, head %d, sector %d\n",
+                track/PHY_HEADS,track%PHY_HEADS,sector);
+        exit(1);
+      }
+  }
+
+void lif_read_phy_blocks(int input_device, int block, int count, unsigned char *data)
+  {
+    int track, sector, n, i;
+    unsigned char *cached;
+
+    while(count > 0)
+      {
+        /* Calculate where this block is on the disk */
+        track=block/PHY_SECTORS;
+        sector=block%PHY_SECTORS;
+        n= PHY_SECTORS-sector;
+        if(n > count) n=count;
+
+        cached=lif_phy_track(input_device,track);
+        if(cached != (unsigned char *) NULL)
+          {
+            memcpy(data,cached+sector*SECTOR_SIZE,n*SECTOR_SIZE);
+          }
+        else
+          {
+            /* the controller reports a bad sector or an invalid address */
+            for(i=0; i< n; i++)
+              {
+                lif_phy_read_sector(input_device,track,sector+i+1,data+i*SECTOR_SIZE);
+              }
+          }
+        block+=n;
+        count-=n;
+        data+=n*SECTOR_SIZE;
+      }
+  }
+
+void lif_write_phy_blocks(int output_device, int block, int count, unsigned char *data)
+  {
+    int track, sector, n;
+
+    while(count > 0)
+      {
+        /* Calculate where this block is on the disk */
+        track=block/PHY_SECTORS;
+        sector=block%PHY_SECTORS;
+        n= PHY_SECTORS-sector;
+        if(n > count) n=count;
+
+        debug_print("write track %d sectors %d..%d\n",track,sector+1,sector+n);
+        lif_phy_seek(output_device,track/PHY_HEADS);
+        controller->write(output_device,track/PHY_HEADS,track%PHY_HEADS,sector+1,n,data);
+        if(track < PHY_TRACKS && track_cache[track] != (unsigned char *) NULL)
+          {
+            memcpy(track_cache[track]+sector*SECTOR_SIZE,data,n*SECTOR_SIZE);
+          }
+        block+=n;
+        count-=n;
+        data+=n*SECTOR_SIZE;
+      }
+  }
+
+void lif_read_phy_block(int input_device, int block, unsigned char *data)
+  {
+    /* Read one block from a physical LIF disk */
+    lif_read_phy_blocks(input_device,block,1,data);
+  }
+
+void lif_write_phy_block(int output_device, int block, unsigned char *data)
+  {
+    /* Write one block to a physical LIF disk */
+    lif_write_phy_blocks(output_device,block,1,data);
+  }
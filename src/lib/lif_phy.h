@@ -1,9 +1,41 @@
-/* lif_phy.h -- header file for physical LIF disk functions (LINUX) */
+/* lif_phy.h -- header file for physical LIF disk functions */
 /* 2000, 2015 A. R. Duell, J. Siebold and placed under the GPL */
 
+/* geometry of a LIF disk as used by the HP 9114/9122 drives */
+#define PHY_CYLINDERS 77
+#define PHY_HEADS 2
+#define PHY_SECTORS 16
+#define PHY_TRACKS (PHY_CYLINDERS*PHY_HEADS)
+
+/* A controller executes the commands of a floppy disk controller.
+   Sectors are numbered from 1, a read or write transfers count
+   consecutive sectors of one track with one command. A read returns -1
+   if a sector cannot be read and 0 otherwise, open returns -1 on error.
+   All other errors are fatal */
+struct lif_phy_controller
+  {
+    int (*open)(char *name);
+    void (*close)(int device);
+    void (*recalibrate)(int device);
+    void (*seek)(int device, int cylinder);
+    int (*read)(int device, int cylinder, int head, int sector, int count,
+              unsigned char *data);
+    void (*write)(int device, int cylinder, int head, int sector, int count,
+              unsigned char *data);
+  };
+
+extern const struct lif_phy_controller lif_fdc_controller;
+/* floppy disk controller of the PC (Linux only) */
+
+extern const struct lif_phy_controller lif_sim_controller;
+/* simulated drive with an in-memory disk, see lif_phy_sim.c */
+
 int lif_open_phy_device(char * devicename);
 /* open a physical device */
 
+int lif_open_phy_controller(const struct lif_phy_controller *controller, char *name);
+/* open a disk with the given controller */
+
 void lif_close_phy_device(int device_id);
 /* close a physical device */
 
@@ -15,17 +47,52 @@ void lif_write_phy_block(int output_device, int block, unsigned char *data);
 /* write the logical block number block to output device and get the
    sector from the buffer *data */
 
+void lif_read_phy_blocks(int input_device, int block, int count, unsigned char *data);
+/* read count consecutive logical blocks. A track is read with one
+   command and kept in the track cache. If the track cannot be read
+   completely, the blocks are read one by one */
+
+void lif_write_phy_blocks(int output_device, int block, int count, unsigned char *data);
+/* write count consecutive logical blocks with one command per track */
+
+/* functions of the PC floppy disk controller */
+
 void lif_recalibrate_phy_device(int device);
 /* recalibrare floppy, seek to sector 0 */
 
 void lif_seek_phy_device(int device, int cylinder);
 /* seek to a specific cylinder on device */
 
-void lif_read_phy_device(int device, int cylinder, int head, int sector,
-              unsigned char *data);
-/* Read one sector from LIF disk to data[] array */
+int lif_read_phy_device(int device, int cylinder, int head, int sector,
+              int count, unsigned char *data);
+/* Read count sectors of a track from LIF disk to data[] array, return -1
+   if a sector cannot be read */
 
 void lif_write_phy_device(int device, int cylinder, int head, int sector,
-               unsigned char *data);
-/* Read one sector from data[] array to LIF disk*/
+               int count, unsigned char *data);
+/* Write count sectors of a track from data[] array to LIF disk*/
+
+/* timing model of the simulated drive */
+
+struct lif_sim_times
+  {
+    char *drive;         /* drive model */
+    long commands;       /* read and write commands */
+    long sectors;        /* sectors transferred */
+    long seeks;
+    long cylinders;      /* sum of the seek distances */
+    long head_switches;
+    double command_ms;   /* controller overhead */
+    double seek_ms;
+    double head_ms;      /* head switch time */
+    double latency_ms;   /* rotational latency */
+    double transfer_ms;
+    double clock_ms;     /* total time */
+  };
+
+int lif_sim_select(char *drive);
+/* select the drive model of the simulation: "9114" (default) or "9122".
+   Return -1 if the model is unknown */
 
+struct lif_sim_times *lif_sim_get_times(void);
+/* get the accumulated times of the simulated drive */
@@ -8,8 +8,9 @@
 
 
 #include<stdio.h>
+#include "lif_phy.h"
 
-int lif_open_phy_device(char * devicename)
+static int lif_fdc_open(char * devicename)
   {
     int device= -1;
     fprintf(stderr,"Low level floppy disc access is not supported on this platform\n");
@@ -17,15 +18,11 @@ int lif_open_phy_device(char * devicename)
     return(device);
   }
 
-void lif_close_phy_device(int descriptor)
+static void lif_fdc_close(int descriptor)
   {
   }
 
-void lif_read_phy_block(int input_device, int block, unsigned char *data)
-  {
-  }
-
-void lif_write_phy_block(int output_device, int block, unsigned char *data)
+void lif_recalibrate_phy_device(int device)
   {
   }
 
@@ -33,12 +30,23 @@ void lif_seek_phy_device(int device, int cylinder)
   {
   }
 
-void lif_read_phy_device(int device, int cylinder, int head, int sector,
-              unsigned char *data)
+int lif_read_phy_device(int device, int cylinder, int head, int sector,
+              int count, unsigned char *data)
   {
+    return(-1);
   }
 
 void lif_write_phy_device(int device, int cylinder, int head, int sector,
-               unsigned char *data)
+              int count, unsigned char *data)
   {
   }
+
+const struct lif_phy_controller lif_fdc_controller=
+  {
+    lif_fdc_open,
+    lif_fdc_close,
+    lif_recalibrate_phy_device,
+    lif_seek_phy_device,
+    lif_read_phy_device,
+    lif_write_phy_device
+  };
@@ -20,6 +20,7 @@
 #include <linux/fd.h>
 #include <linux/fdreg.h>
 #include "lif_phy.h"
+#include "lif_img.h"
 #include "lif_const.h"
 
 /* Data rate selection code for 250kbps */
@@ -31,70 +32,25 @@
 #define FD_DD_READ 0x46
 
 
-static int current_cylinder;
-
-
-int lif_open_phy_device(char * devicename)
+static int lif_fdc_open(char * devicename)
   {
     int device;
 
     device=open(devicename,3,0);
-    if(device != -1) 
+    /* the drive can serve only one process at a time */
+    if(device != -1 && lif_lock_file(device,1,devicename))
     {
-       /* Move the drive head to cylinder 0 and set current_cylinder */
-       lif_recalibrate_phy_device(device);
-       current_cylinder=0;
+       close(device);
+       return(-1);
     }
     return(device);
   }
 
-void lif_close_phy_device(int descriptor)
+static void lif_fdc_close(int descriptor)
   {
      close(descriptor);
   }
 
-void lif_read_phy_block(int input_device, int block, unsigned char *data)
-  {
-    /* Read one block from a physical LIF disk */
-    int cylinder, head, sector;
-
-    /* Calculate where this block is on the disk */
-    cylinder=block/32;
-    head=(block/16)%2;
-    sector=(block%16)+1;
-
-    /* If we're not on the right cylinder, go there */
-    if(cylinder!=current_cylinder)
-      {
-        lif_seek_phy_device(input_device,cylinder);
-        current_cylinder=cylinder;
-      }
-
-    /* Now read the block */
-    lif_read_phy_device(input_device,cylinder,head,sector,data);
-  }
-
-void lif_write_phy_block(int output_device, int block, unsigned char *data)
-  {
-    /* Read one block from a physical LIF disk */
-    int cylinder, head, sector;
-  
-    /* Calculate where this block is on the disk */
-    cylinder=block/32;
-    head=(block/16)%2;
-    sector=(block%16)+1;
-    
-    /* If we're not on the right cylinder, go there */
-    if(cylinder!=current_cylinder)
-      {
-        lif_seek_phy_device(output_device,cylinder);
-        current_cylinder=cylinder;
-      }
-
-    /* Now write the block */
-    lif_write_phy_device(output_device,cylinder,head,sector,data);
-  }
-
 
 void lif_recalibrate_phy_device(int device)
   {
@@ -155,13 +111,13 @@ void lif_seek_phy_device(int device, int cylinder)
       }
   }
 
-void lif_read_phy_device(int device, int cylinder, int head, int sector, 
-              unsigned char *data)
+int lif_read_phy_device(int device, int cylinder, int head, int sector, 
+              int count, unsigned char *data)
   {
     struct floppy_raw_cmd cmd;
 
     cmd.data=data;  /* Data buffer to transfer */
-    cmd.length=SECTOR_SIZE; /* length of data */
+    cmd.length=count*SECTOR_SIZE; /* length of data */
     cmd.rate=RATE250; /* 250 kbps */
     cmd.flags=FD_RAW_INTR | FD_RAW_READ; /* Set up DMA, etc */
     cmd.cmd[0]=FD_DD_READ; /* read command */
@@ -170,26 +126,24 @@ void lif_read_phy_device(int device, int cylinder, int head, int sector,
     cmd.cmd[3]=head?1:0; /* Head value (to check with header) */
     cmd.cmd[4]=sector; /* Sector to search for */
     cmd.cmd[5]=1; /* 256 byte MFM sectors */
-    cmd.cmd[6]=16; /* last sector number on a track */
+    cmd.cmd[6]=sector+count-1; /* last sector to transfer */
     cmd.cmd[7]=32; /* gap length */
     cmd.cmd[8]=0xFF; /* 256 bytes, but shouldn't be needed */
     cmd.cmd_count=9;
     if ((ioctl(device,FDRAWCMD,&cmd)<0) || (cmd.reply[0] & 0xC0))
       {
-        fprintf(stderr,"Error reading cylinder %d, head %d, sector %d\n",
-                cylinder,head,sector);
-         fprintf(stderr,"error= %s (%d)\n",strerror(errno),errno);
-        exit(1);
+        return(-1);
       }
+    return(0);
   }
 
 void lif_write_phy_device(int device, int cylinder, int head, int sector, 
-               unsigned char *data)
+              int count, unsigned char *data)
   {
     struct floppy_raw_cmd cmd;
 
     cmd.data=data;  /* Data buffer to transfer */
-    cmd.length=SECTOR_SIZE; /* length of data */
+    cmd.length=count*SECTOR_SIZE; /* length of data */
     cmd.rate=RATE250; /* 250 kbps */
     cmd.flags=FD_RAW_INTR | FD_RAW_WRITE; /* Set up DMA, etc */
     cmd.cmd[0]=FD_DD_WRITE; /* write command */
@@ -198,7 +152,7 @@ void lif_write_phy_device(int device, int cylinder, int head, int sector,
     cmd.cmd[3]=head?1:0; /* Head value (to check with header) */
     cmd.cmd[4]=sector; /* Sector to search for */
     cmd.cmd[5]=1; /* 256 byte MFM sectors */
-    cmd.cmd[6]=16; /* last sector number on a track */
+    cmd.cmd[6]=sector+count-1; /* last sector to transfer */
     cmd.cmd[7]=32; /* gap length */
     cmd.cmd[8]=0xFF; /* 256 bytes, but shouldn't be needed */
     cmd.cmd_count=9;
@@ -211,3 +165,12 @@ void lif_write_phy_device(int device, int cylinder, int head, int sector,
       }
   }
 
+const struct lif_phy_controller lif_fdc_controller=
+  {
+    lif_fdc_open,
+    lif_fdc_close,
+    lif_recalibrate_phy_device,
+    lif_seek_phy_device,
+    lif_read_phy_device,
+    lif_write_phy_device
+  };
@@ -0,0 +1,240 @@
+/* lif_phy_sim.c -- simulated HP 9114/9122 disk drive */
+/* 2026 J. Siebold and placed under the GPL */
+
+/* The simulated controller executes the commands of the physical disk
+   layer (lif_phy.c) on a disk in memory. It is selected by the prefix
+   "sim:" of a LIF image file name. The image file is loaded into the
+   simulated disk when it is opened and the modified sectors are written
+   back when it is closed. Like the real controller, a sector can only be
+   accessed if the head was moved to its cylinder before.
+
+   A timing model of the drive accounts for
+
+   - the command overhead of the controller
+   - the seek to another cylinder: settle time plus step time per cylinder
+   - the switch to the other head
+   - the rotational latency until the first sector passes the head
+   - the transfer of the sectors
+
+   The drive parameters are nominal values, they are meant to compare
+   access patterns rather than to predict the exact time. If statistics
+   are enabled (see lif_stats.c) the accumulated times are output as JSON
+   to standard error when the disk is closed. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include "config.h"
+#include "lif_const.h"
+#include "lif_img.h"
+#include "lif_phy.h"
+#include "lif_stats.h"
+
+#define SIM_BLOCKS (PHY_TRACKS*PHY_SECTORS)
+
+struct lif_sim_drive
+  {
+    char *name;
+    double rpm;        /* rotational speed */
+    double step_ms;    /* step time per cylinder */
+    double settle_ms;  /* head settle time after a seek */
+    double head_ms;    /* head switch time */
+    double command_ms; /* controller overhead per command */
+  };
+
+static struct lif_sim_drive lif_sim_drives[]=
+  {
+    { "9114", 600.0, 6.0, 15.0, 1.0, 3.0 },
+    { "9122", 600.0, 3.0, 15.0, 1.0, 1.0 },
+    { (char *) NULL, 0.0, 0.0, 0.0, 0.0, 0.0 }
+  };
+
+static struct lif_sim_drive *sim_drive= lif_sim_drives;
+static struct lif_sim_times sim_times;
+static int sim_cylinder;      /* cylinder of the head */
+static int sim_head;          /* selected head */
+static unsigned char *sim_disk= (unsigned char *) NULL;
+static unsigned char sim_dirty[SIM_BLOCKS]; /* modified sectors */
+static int sim_fd= -1;        /* image file, -1 for a blank disk */
+
+int lif_sim_select(char *drive)
+  {
+    struct lif_sim_drive *d;
+
+    for(d= lif_sim_drives; d->name != (char *) NULL; d++)
+      {
+        if(strcmp(d->name,drive)==0)
+          {
+            sim_drive=d;
+            return(0);
+          }
+      }
+    return(-1);
+  }
+
+struct lif_sim_times *lif_sim_get_times(void)
+  {
+    return(&sim_times);
+  }
+
+static int lif_sim_open(char *name)
+  {
+    /* load the image file name into the simulated disk, a NULL name
+       gives a blank disk */
+    int blocks;
+
+    memset(&sim_times,0,sizeof(sim_times));
+    sim_times.drive=sim_drive->name;
+    sim_cylinder=0;
+    sim_head=0;
+    memset(sim_dirty,0,SIM_BLOCKS);
+    sim_disk=calloc(SIM_BLOCKS,SECTOR_SIZE);
+    if(sim_disk == (unsigned char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    sim_fd= -1;
+    if(name == (char *) NULL) return(0);
+
+    sim_fd=lif_open_img_file(name,O_RDWR | O_BINARY,0);
+    if(sim_fd == -1) return(-1);
+    blocks=lif_img_file_blocks(sim_fd);
+    if(blocks > SIM_BLOCKS)
+      {
+        fprintf(stderr,"Image file %s is too large for a floppy disk\n",name);
+        lif_close_img_file(sim_fd);
+        return(-1);
+      }
+    if(blocks) lif_read_img_blocks(sim_fd,0,blocks,sim_disk);
+    return(sim_fd);
+  }
+
+static void lif_sim_close(int device)
+  {
+    int i, first;
+
+    (void) device;
+    if(sim_fd != -1)
+      {
+        /* write back the modified sectors */
+        i=0;
+        while(i < SIM_BLOCKS)
+          {
+            if(! sim_dirty[i])
+              {
+                i++;
+                continue;
+              }
+            first=i;
+            while(i < SIM_BLOCKS && sim_dirty[i]) i++;
+            lif_write_img_blocks(sim_fd,first,i-first,sim_disk+first*SECTOR_SIZE);
+          }
+        lif_close_img_file(sim_fd);
+        sim_fd= -1;
+      }
+    free(sim_disk);
+    sim_disk= (unsigned char *) NULL;
+    if(lif_stats_enabled)
+      {
+        fprintf(stderr,"{\"drive\":\"%s\",\"commands\":%ld,\"sectors\":%ld,",sim_times.drive,sim_times.commands,sim_times.sectors);
+        fprintf(stderr,"\"seeks\":%ld,\"cylinders\":%ld,\"head_switches\":%ld,",sim_times.seeks,sim_times.cylinders,sim_times.head_switches);
+        fprintf(stderr,"\"simulated_time\":%.3f}\n",sim_times.clock_ms/1000.0);
+      }
+  }
+
+static void lif_sim_seek(int device, int cylinder)
+  {
+    int distance;
+    double t;
+
+    (void) device;
+    if(cylinder < 0 || cylinder >= PHY_CYLINDERS)
+      {
+        fprintf(stderr,"Error on seek to cylinder %d\n",cylinder);
+        exit(1);
+      }
+    if(cylinder == sim_cylinder) return;
+    distance= cylinder > sim_cylinder ? cylinder-sim_cylinder : sim_cylinder-cylinder;
+    t= sim_drive->settle_ms + sim_drive->step_ms * distance;
+    sim_times.clock_ms+=t;
+    sim_times.seek_ms+=t;
+    sim_times.seeks++;
+    sim_times.cylinders+=distance;
+    sim_cylinder=cylinder;
+  }
+
+static void lif_sim_recalibrate(int device)
+  {
+    lif_sim_seek(device,0);
+  }
+
+static int lif_sim_transfer(int cylinder, int head, int sector, int count)
+  {
+    /* account the time of a read or write command and return the first
+       block or -1 if the sectors cannot be found */
+    double revolution, sector_ms, wait;
+
+    if(cylinder != sim_cylinder || head < 0 || head >= PHY_HEADS || sector < 1 ||
+       count < 1 || sector+count-1 > PHY_SECTORS) return(-1);
+
+    revolution= 60000.0 / sim_drive->rpm;
+    sector_ms= revolution / PHY_SECTORS;
+    sim_times.commands++;
+    sim_times.sectors+=count;
+    sim_times.clock_ms+=sim_drive->command_ms;
+    sim_times.command_ms+=sim_drive->command_ms;
+    if(head != sim_head)
+      {
+        sim_times.clock_ms+=sim_drive->head_ms;
+        sim_times.head_ms+=sim_drive->head_ms;
+        sim_times.head_switches++;
+        sim_head=head;
+      }
+    /* wait until the first sector arrives, sectors are not interleaved */
+    wait= (sector-1) * sector_ms - (sim_times.clock_ms - (double) ((long) (sim_times.clock_ms/revolution)) * revolution);
+    if(wait < 0.0) wait+=revolution;
+    sim_times.clock_ms+=wait;
+    sim_times.latency_ms+=wait;
+    sim_times.clock_ms+=count*sector_ms;
+    sim_times.transfer_ms+=count*sector_ms;
+    return((cylinder*PHY_HEADS+head)*PHY_SECTORS+sector-1);
+  }
+
+static int lif_sim_read(int device, int cylinder, int head, int sector, int count,
+              unsigned char *data)
+  {
+    int block;
+
+    (void) device;
+    if((block=lif_sim_transfer(cylinder,head,sector,count)) == -1) return(-1);
+    memcpy(data,sim_disk+block*SECTOR_SIZE,count*SECTOR_SIZE);
+    return(0);
+  }
+
+static void lif_sim_write(int device, int cylinder, int head, int sector, int count,
+              unsigned char *data)
+  {
+    int block;
+
+    (void) device;
+    if((block=lif_sim_transfer(cylinder,head,sector,count)) == -1)
+      {
+        fprintf(stderr,"Error writing cylinder %d, head %d, sector %d\n",
+                cylinder,head,sector);
+        exit(1);
+      }
+    memcpy(sim_disk+block*SECTOR_SIZE,data,count*SECTOR_SIZE);
+    memset(sim_dirty+block,1,count);
+  }
+
+const struct lif_phy_controller lif_sim_controller=
+  {
+    lif_sim_open,
+    lif_sim_close,
+    lif_sim_recalibrate,
+    lif_sim_seek,
+    lif_sim_read,
+    lif_sim_write
+  };
@@ -0,0 +1,127 @@
+/* lif_record.c -- record level access to data files inside a LIF medium */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* Records of HP-71 DATA files and HP-41 SDATA files have a fixed length,
+   so the block and offset of record n is known from the directory entry
+   alone. Reading or updating a record only touches the blocks it spans,
+   the rest of the file is neither read nor rewritten. */
+
+#include <stdio.h>
+#include <string.h>
+#include "lifutils.h"
+#include "lif_block.h"
+#include "lif_dir_utils.h"
+#include "lif_const.h"
+#include "lif_record.h"
+
+int lif_find_entry(int device, char *cmp_name, unsigned char *entry)
+  {
+    unsigned char dir_data[SECTOR_SIZE];
+    unsigned int dir_start, dir_length, dir_block, dir_entry, file_type;
+
+    lif_read_block(device,0,dir_data);
+    if(get_lif_int(dir_data+0,2)!=0x8000) return(-2);
+    dir_start=get_lif_int(dir_data+8,4);
+    dir_length=get_lif_int(dir_data+16,4);
+
+    for(dir_block=0; dir_block<dir_length; dir_block++)
+      {
+        lif_read_block(device,dir_block+dir_start,dir_data);
+        for(dir_entry=0; dir_entry<8; dir_entry++)
+          {
+            file_type=get_lif_int(dir_data+(dir_entry<<5)+10,2);
+            if(file_type==0) continue; /* Skip deleted files */
+            if(file_type==0xFFFF) return(-1); /* End of directory */
+            if(compare_names((char *)dir_data+(dir_entry<<5),cmp_name))
+              {
+                memcpy(entry,dir_data+(dir_entry<<5),ENTRY_SIZE);
+                return(dir_block*8+dir_entry);
+              }
+          }
+      }
+    return(-1);
+  }
+
+int lif_record_layout(unsigned char *entry, int *record_length, int *num_records)
+  {
+    switch(get_lif_int(entry+10,2))
+      {
+        case 0xE0F0: /* DAT71, values are LSB first */
+        case 0xE0F1: /* secured DAT71 */
+          *num_records=(*(entry+28)) + ((*(entry+29))<<8);
+          *record_length=(*(entry+30)) + ((*(entry+31))<<8);
+          break;
+        case 0xE0D0: /* SDATA, one register per record */
+          *num_records=get_lif_int(entry+28,2);
+          *record_length=SDATA_RECORD_SIZE;
+          break;
+        default:
+          return(-1);
+      }
+    if(*record_length==0) return(-1);
+    return(0);
+  }
+
+int lif_record_secured(unsigned char *entry)
+  {
+    return(get_lif_int(entry+10,2) == 0xE0F1);
+  }
+
+/* Check the record range and compute its position in the medium */
+static int lif_record_range(unsigned char *entry, int first, int count,
+                            int *start_block, int *offset, int *length)
+  {
+    int record_length, num_records;
+    long pos;
+
+    if(lif_record_layout(entry,&record_length,&num_records)) return(-1);
+    if(first < 0 || count < 1 || first+count > num_records) return(-1);
+    pos=(long) first*record_length;
+    *length=count*record_length;
+    if(pos + *length > (long) get_lif_int(entry+16,4)*BLOCK_SIZE) return(-1);
+    *start_block=get_lif_int(entry+12,4) + (int) (pos/BLOCK_SIZE);
+    *offset=(int) (pos % BLOCK_SIZE);
+    return(0);
+  }
+
+int lif_read_records(int device, unsigned char *entry, int first, int count, unsigned char *data)
+  {
+    unsigned char block[BLOCK_SIZE];
+    int blocknum, offset, length, n;
+
+    if(lif_record_range(entry,first,count,&blocknum,&offset,&length)) return(-1);
+    while(length > 0)
+      {
+        n=BLOCK_SIZE-offset;
+        if(n > length) n=length;
+        lif_read_block(device,blocknum,block);
+        memcpy(data,block+offset,n);
+        data+=n;
+        length-=n;
+        offset=0;
+        blocknum++;
+      }
+    return(0);
+  }
+
+int lif_write_records(int device, unsigned char *entry, int first, int count, unsigned char *data)
+  {
+    unsigned char block[BLOCK_SIZE];
+    int blocknum, offset, length, n;
+
+    if(lif_record_range(entry,first,count,&blocknum,&offset,&length)) return(-1);
+    while(length > 0)
+      {
+        n=BLOCK_SIZE-offset;
+        if(n > length) n=length;
+        /* only partially covered blocks need to be read first */
+        if(n < BLOCK_SIZE) lif_read_block(device,blocknum,block);
+        memcpy(block+offset,data,n);
+        lif_write_block(device,blocknum,block);
+        data+=n;
+        length-=n;
+        offset=0;
+        blocknum++;
+      }
+    return(0);
+  }
@@ -0,0 +1,28 @@
+/* lif_record.h -- record level access to data files inside a LIF medium */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#ifndef LIF_RECORD_H
+#define LIF_RECORD_H
+
+int lif_find_entry(int device, char *cmp_name, unsigned char *entry);
+/* Search the directory of device for the space padded file name cmp_name.
+   Copy the directory entry to entry and return its index, -1 if the file
+   was not found and -2 if device is not a LIF medium */
+
+int lif_record_layout(unsigned char *entry, int *record_length, int *num_records);
+/* Get record length and number of records of a DAT71 or SDATA file.
+   Return -1 if the directory entry is not a record oriented file */
+
+int lif_record_secured(unsigned char *entry);
+/* Return 1 if the HP-71 marks the file as secured (DAT71 type E0F1) */
+
+int lif_read_records(int device, unsigned char *entry, int first, int count, unsigned char *data);
+/* Read count records starting at record first (counted from 0) of the
+   file described by entry into data. Return -1 if out of range */
+
+int lif_write_records(int device, unsigned char *entry, int first, int count, unsigned char *data);
+/* Overwrite count records starting at record first of the file described
+   by entry with data. Only the blocks holding the records are touched.
+   Return -1 if out of range */
+
+#endif
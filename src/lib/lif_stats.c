@@ -0,0 +1,223 @@
+/* lif_stats.c -- block i/o and phase statistics of a command */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* The statistics are collected if the environment variable LIFUTILSSTATS
+   is set or lifutils is called with --stats. At exit a JSON object is
+   written to standard error:
+
+   - the number of block reads and writes, the number of distinct blocks
+     accessed and the number of bytes read and written
+   - the number of seeks, an access which does not start behind the end of
+     the previous one, with a histogram of the seek distances in blocks
+   - the time spent in the phases of the command in seconds
+   - the peak resident set size of the process in KB, if available
+
+   If the environment variable LIFUTILSTRACE names a file or lifutils is
+   called with --trace FILE, every block access is logged to that file as
+   a line "R|W block count seconds", see liftrace.c
+
+   If LIFUTILSREGRESSIONTEST is set, times and memory are output as zero */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "config.h"
+#ifdef HAVE_GETRUSAGE
+#include <sys/resource.h>
+#endif
+#include "lif_const.h"
+#include "lif_stats.h"
+
+int lif_stats_enabled=0;
+
+static int stats_report=0;         /* output statistics at exit */
+static int stats_regression=0;     /* regression test mode */
+static FILE *stats_trace_file= (FILE *) NULL;
+static double stats_start;         /* time of lif_stats_start */
+static char *stats_command="";
+static long stats_reads=0;         /* block reads */
+static long stats_writes=0;        /* block writes */
+static long stats_bytes_read=0;
+static long stats_bytes_written=0;
+static long stats_seeks=0;
+static long stats_seek_blocks=0;   /* sum of the seek distances */
+static int stats_position=0;       /* block behind the last access */
+
+/* upper bounds of the seek distance histogram, the last bucket is open */
+#define SEEK_BUCKETS 4
+static int seek_limits[SEEK_BUCKETS-1]= { 32, 256, 2048 };
+static char *seek_names[SEEK_BUCKETS]= { "1-31", "32-255", "256-2047", "2048-" };
+static long seek_histogram[SEEK_BUCKETS];
+
+/* bitmap of the accessed blocks */
+static unsigned char *stats_map= (unsigned char *) NULL;
+static int stats_map_size=0;       /* size in bytes */
+
+static char *phase_names[LIF_PHASES]= { "other", "header", "directory",
+   "allocation", "copy", "commit" };
+static double phase_time[LIF_PHASES];
+static int stats_phase=LIF_PHASE_OTHER;
+static double stats_phase_start;
+
+static double lif_stats_clock(void)
+  {
+    /* seconds since an arbitrary point of time */
+#ifdef HAVE_CLOCK_GETTIME
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return((double) ts.tv_sec+ (double) ts.tv_nsec/1.0e9);
+#else
+    return((double) clock()/CLOCKS_PER_SEC);
+#endif
+  }
+
+static void lif_stats_mark(int block, int count)
+  {
+    /* mark count blocks starting at block as accessed */
+    int new_size, i;
+
+    if(block < 0 || count <= 0) return;
+    if((block+count+7)/8 > stats_map_size)
+      {
+        new_size= stats_map_size ? stats_map_size : 256;
+        while(new_size < (block+count+7)/8) new_size*=2;
+        stats_map=realloc(stats_map,new_size);
+        if(stats_map == (unsigned char *) NULL)
+          {
+            fprintf(stderr,"Cannot allocate memory\n");
+            exit(1);
+          }
+        for(i=stats_map_size;i<new_size;i++) stats_map[i]=0;
+        stats_map_size=new_size;
+      }
+    for(i=block;i<block+count;i++) stats_map[i>>3]|= 1 << (i & 7);
+  }
+
+static long lif_stats_distinct(void)
+  {
+    long n=0;
+    int i, j;
+
+    for(i=0;i<stats_map_size;i++)
+      {
+        for(j=0;j<8;j++) if(stats_map[i] & (1<<j)) n++;
+      }
+    return(n);
+  }
+
+static long lif_stats_peak_kb(void)
+  {
+#ifdef HAVE_GETRUSAGE
+    struct rusage usage;
+
+    if(getrusage(RUSAGE_SELF,&usage)) return(0);
+#ifdef __APPLE__
+    return(usage.ru_maxrss/1024);
+#else
+    return(usage.ru_maxrss);
+#endif
+#else
+    return(0);
+#endif
+  }
+
+static void lif_stats_exit(void)
+  {
+    int i;
+
+    if(stats_trace_file != (FILE *) NULL)
+      {
+        if(fclose(stats_trace_file))
+          {
+            fprintf(stderr,"Error writing trace file\n");
+          }
+        stats_trace_file= (FILE *) NULL;
+      }
+    if(! stats_report) return;
+    lif_stats_phase(LIF_PHASE_OTHER);
+    fprintf(stderr,"{\"command\":\"%s\",",stats_command);
+    fprintf(stderr,"\"block_reads\":%ld,\"block_writes\":%ld,",stats_reads,stats_writes);
+    fprintf(stderr,"\"distinct_blocks\":%ld,",lif_stats_distinct());
+    fprintf(stderr,"\"bytes_read\":%ld,\"bytes_written\":%ld,",stats_bytes_read,stats_bytes_written);
+    fprintf(stderr,"\"seeks\":%ld,\"seek_blocks\":%ld,\"seek_distance\":{",stats_seeks,stats_seek_blocks);
+    for(i=0;i<SEEK_BUCKETS;i++)
+      {
+        fprintf(stderr,"%s\"%s\":%ld",i ? "," : "",seek_names[i],seek_histogram[i]);
+      }
+    fprintf(stderr,"},\"phases\":{");
+    for(i=0;i<LIF_PHASES;i++)
+      {
+        fprintf(stderr,"%s\"%s\":%.6f",i ? "," : "",phase_names[i],stats_regression ? 0.0 : phase_time[i]);
+      }
+    fprintf(stderr,"},\"peak_rss_kb\":%ld}\n",stats_regression ? 0L : lif_stats_peak_kb());
+    free(stats_map);
+  }
+
+static void lif_stats_start(void)
+  {
+    /* start collecting, the first caller registers the exit handler */
+    if(lif_stats_enabled) return;
+    stats_regression= getenv("LIFUTILSREGRESSIONTEST") != (char *) NULL;
+    stats_phase=LIF_PHASE_OTHER;
+    stats_start=lif_stats_clock();
+    stats_phase_start=stats_start;
+    lif_stats_enabled=1;
+    atexit(lif_stats_exit);
+  }
+
+void lif_stats_init(char *command)
+  {
+    stats_command=command;
+    stats_report=1;
+    lif_stats_start();
+  }
+
+int lif_stats_trace(char *filename)
+  {
+    stats_trace_file=fopen(filename,"w");
+    if(stats_trace_file == (FILE *) NULL) return(-1);
+    lif_stats_start();
+    return(0);
+  }
+
+void lif_stats_io(int write, int block, int count)
+  {
+    int distance, i;
+
+    if(stats_trace_file != (FILE *) NULL)
+      {
+        fprintf(stats_trace_file,"%c %d %d %.6f\n",write ? 'W' : 'R',block,count,
+           stats_regression ? 0.0 : lif_stats_clock()-stats_start);
+      }
+    if(write)
+      {
+        stats_writes+=count;
+        stats_bytes_written+=(long) count*SECTOR_SIZE;
+      }
+    else
+      {
+        stats_reads+=count;
+        stats_bytes_read+=(long) count*SECTOR_SIZE;
+      }
+    if(block != stats_position)
+      {
+        distance= block > stats_position ? block-stats_position : stats_position-block;
+        stats_seeks++;
+        stats_seek_blocks+=distance;
+        for(i=0;i<SEEK_BUCKETS-1;i++) if(distance < seek_limits[i]) break;
+        seek_histogram[i]++;
+      }
+    stats_position=block+count;
+    lif_stats_mark(block,count);
+  }
+
+void lif_stats_phase(int phase)
+  {
+    double now;
+
+    now=lif_stats_clock();
+    phase_time[stats_phase]+=now-stats_phase_start;
+    stats_phase_start=now;
+    stats_phase=phase;
+  }
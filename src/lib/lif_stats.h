@@ -0,0 +1,35 @@
+/* lif_stats.h -- block i/o and phase statistics of a command */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#ifndef LIF_STATS_H
+#define LIF_STATS_H
+
+/* phases of a command, time outside of a phase is reported as "other" */
+#define LIF_PHASE_OTHER 0
+#define LIF_PHASE_HEADER 1     /* read and check the volume header */
+#define LIF_PHASE_DIRECTORY 2  /* scan the directory */
+#define LIF_PHASE_ALLOCATION 3 /* find space for a file */
+#define LIF_PHASE_COPY 4       /* copy file data */
+#define LIF_PHASE_COMMIT 5     /* write the directory */
+#define LIF_PHASES 6
+
+extern int lif_stats_enabled;
+
+void lif_stats_init(char *command);
+/* start collecting statistics for command. They are output as JSON to
+   standard error at exit */
+
+int lif_stats_trace(char *filename);
+/* log every block access to the trace file filename. Return -1 if the
+   file cannot be created */
+
+void lif_stats_io(int write, int block, int count);
+/* count a read (write=0) or write of count blocks starting at block */
+
+void lif_stats_phase(int phase);
+/* enter a phase, the time is accounted to the previous phase */
+
+#define LIF_STATS_PHASE(p) do { if (lif_stats_enabled) lif_stats_phase(p); } while (0)
+#define LIF_STATS_IO(w,b,c) do { if (lif_stats_enabled) lif_stats_io(w,b,c); } while (0)
+
+#endif
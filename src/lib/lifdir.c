@@ -3,125 +3,643 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
 #include <fcntl.h>
+#include <errno.h>
 #include "config.h"
+#ifdef HAVE_INOTIFY
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 #include "lifutils.h"
 #include "lif_block.h"
 #include "lif_dir_utils.h"
+#include "lif_filetype.h"
 #include "lif_const.h"
 
 
 /* csv separator */
 #define SEP ','
 
+/* output formats */
+#define FMT_LIST 0    /* default listing, controlled by verbosity */
+#define FMT_CSV_OLD 1 /* -c csv output */
+#define FMT_CSV 2     /* -f csv: quoted csv with header line */
+#define FMT_JSON 3    /* -f json: one JSON object per line */
+
+/* sort keys */
+#define SORT_NONE 0
+#define SORT_NAME 1
+#define SORT_SIZE 2
+#define SORT_START 3
+#define SORT_DATE 4
+
+/* wait for further changes before reading the directory in watch mode */
+#define WATCH_SETTLE_MS 100
+
+/* initial size of the output buffer */
+#define OUTBUF_SIZE 65536
+
+/* All output is formatted into one buffer which is written at the end */
+static char *outbuf;
+static int outbuf_len;
+static int outbuf_size;
+
+/* a directory entry together with its position in the directory */
+struct lifdir_entry
+  {
+    int index;
+    unsigned char data[ENTRY_SIZE];
+  };
+static int sort_key;
+
+static void lifdir_reserve(int n)
+  {
+    /* make sure that there is room for n more bytes in the output buffer */
+    if(outbuf_len+n < outbuf_size) return;
+    outbuf_size= 2*outbuf_size+n;
+    outbuf=realloc(outbuf,outbuf_size);
+    if(outbuf == (char *) NULL)
+      {
+        fprintf(stderr,"cannot allocate output buffer\n");
+        exit(EXIT_ERROR);
+      }
+  }
+
+static void lifdir_out(char *fmt, ...)
+  {
+    va_list args;
+    int n;
+
+    while(1)
+      {
+        va_start(args,fmt);
+        n=vsnprintf(outbuf+outbuf_len,outbuf_size-outbuf_len,fmt,args);
+        va_end(args);
+        if(n < 0) return;
+        if(n < outbuf_size-outbuf_len) break;
+        /* enlarge buffer and try again */
+        lifdir_reserve(n);
+      }
+    outbuf_len+=n;
+  }
+
+static void lifdir_out_bytes(unsigned char *data, int n)
+  {
+    /* copy n bytes unchanged to the output buffer */
+    lifdir_reserve(n);
+    memcpy(outbuf+outbuf_len,data,n);
+    outbuf_len+=n;
+  }
+
+static void lifdir_out_date(unsigned char *date)
+  {
+    /* Output an HP-style date and time stamp. On entry, date points to
+       the first byte of a 6-byte time stamp */
+    lifdir_out("%02d/%02d/%02d %02d:%02d:%02d",
+         bcd_to_dec(*(date+DAY_OFF)),
+         bcd_to_dec(*(date+MONTH_OFF)),
+         bcd_to_dec(*(date+YEAR_OFF)),
+         bcd_to_dec(*(date+HOUR_OFF)),
+         bcd_to_dec(*(date+MINUTE_OFF)),
+         bcd_to_dec(*(date+SECOND_OFF)));
+  }
+
+static int lifdir_year(unsigned char *date)
+  {
+    /* the time stamp has a two digit year, assume 1970..2069 */
+    int year;
+
+    year=bcd_to_dec(*(date+YEAR_OFF));
+    return(year < 70 ? 2000+year : 1900+year);
+  }
+
+static void lifdir_out_iso_date(unsigned char *date)
+  {
+    /* Output a time stamp in ISO 8601 format */
+    lifdir_out("%04d-%02d-%02dT%02d:%02d:%02d",
+         lifdir_year(date),
+         bcd_to_dec(*(date+MONTH_OFF)),
+         bcd_to_dec(*(date+DAY_OFF)),
+         bcd_to_dec(*(date+HOUR_OFF)),
+         bcd_to_dec(*(date+MINUTE_OFF)),
+         bcd_to_dec(*(date+SECOND_OFF)));
+  }
+
+static int lifdir_name_length(unsigned char *entry)
+  {
+    /* length of the file name without trailing blanks */
+    int i;
+
+    for(i=NAME_LEN; i>0; i--)
+      {
+        if(*(entry+i-1) != ' ') break;
+      }
+    return(i);
+  }
+
 void lifdir_print_dir_entry(unsigned char *entry, int verbosity)
   {
-    /* Decode and print a directory entry. entry points to a 32 byte 
+    /* Decode and print a directory entry. entry points to a 32 byte
        directory entry, as described in appendix D of the HP71 HPIL
        owner's manual */
     int i; /* general counter */
     int length; /* File length from directory */
     int total_blocks; /* Number of blocks occupied by file */
     int start_block; /* file start block */
-    unsigned int implementation_byte; /* implementation byte */
 
     char file_type[10]; /* storage for the file type string */
 
     /* Print the filename */
-    for(i=0; i<10; i++)
-      {
-        putchar(*(entry+i));
-      }
+    lifdir_out_bytes(entry,NAME_LEN);
     /* default directory listing */
     if(verbosity > 0)
       {
        /* find and print the file type */
        length=file_length(entry,file_type);
-       printf("  %-10s  ",file_type);
        total_blocks=get_lif_int(entry+16,4);
-       /* Print the length, both from the directory, and from the number of 
+       /* Print the length, both from the directory, and from the number of
           blocks */
-       printf("%5d/%-5d    ",length,total_blocks*256);
+       lifdir_out("  %-10s  %5d/%-5d    ",file_type,length,total_blocks*256);
        /* Print the file time and date */
        if(*(entry+21))
          {
            /* If the month is not 0, it's a valid date */
-           print_date(entry+20);
+           lifdir_out_date(entry+20);
          }
-       else printf("                 ");
+       else lifdir_out("                 ");
       }
     /* output additional information */
     if (verbosity > 1)
       {
        start_block=get_lif_int(entry+12,4);
-       printf("%5d %5d ",start_block, total_blocks);
+       lifdir_out("%5d %5d ",start_block, total_blocks);
        for(i=0; i<6; i++)
          {
-            implementation_byte=(unsigned char) get_lif_int(entry+26+i,1);
-            printf("%02X",implementation_byte);
+            lifdir_out("%02X",*(entry+26+i));
          }
-            
       }
-    
-    printf("\n");
-  } 
+    lifdir_out("\n");
+  }
 
 void lifdir_csv_dir_entry(unsigned char *entry)
   {
-    /* Decode a directory entry and output it as csv. entry points to a 32 
+    /* Decode a directory entry and output it as csv. entry points to a 32
        byte directory entry, as described in appendix D of the HP71 HPIL
        owner's manual */
     int i; /* general counter */
     int length; /* File length from directory */
     char file_type[10]; /* storage for the file type string */
 
-    /* output the filename */
-    for(i=0; i<10; i++)
+    /* output the filename up to the first blank */
+    for(i=0; i<NAME_LEN; i++)
       {
 	if( *(entry+i) == ' ') break;
-        putchar(*(entry+i));
       }
-    printf("%c",SEP);
+    lifdir_out_bytes(entry,i);
+    lifdir_out("%c",SEP);
 
-    /* output the file type */
+    /* output the file type, the file type code, the file length,
+       the start block and the number of blocks */
     length=file_length(entry,file_type);
-    printf("%s",file_type);
-    printf("%c",SEP);
+    lifdir_out("%s%c%d%c%d%c%d%c%d",file_type,SEP,get_lif_int(entry+10,2),
+       SEP,length,SEP,get_lif_int(entry+12,4),SEP,get_lif_int(entry+16,4));
 
-    /* output the file type in hex */
-    printf("%d", get_lif_int(entry+10,2));
-    printf("%c",SEP);
+    /* output date and time */
+    for (i=0; i<6; i++)
+      {
+         lifdir_out("%c%d",SEP,bcd_to_dec(*(entry+20+i)));
+      }
 
-    /* output the file length */
-    printf("%d",length);
-    printf("%c",SEP);
+    /* output the impelentation bytes */
+    for(i=0; i<6; i++)
+      {
+         lifdir_out("%c%d",SEP,*(entry+26+i));
+      }
+    lifdir_out("\n");
+  }
 
-    /* output the start block */
-    printf("%d",get_lif_int(entry+12,4));
-    printf("%c",SEP);
+static void lifdir_quoted(unsigned char *s, int len, int json)
+  {
+    /* output a string as a quoted csv field or JSON string */
+    int i;
 
-    /* output the number of blocks */
-    printf("%d",get_lif_int(entry+16,4));
+    lifdir_out("\"");
+    for(i=0; i<len; i++)
+      {
+        if(json)
+          {
+            if(s[i]=='"' || s[i]=='\\') lifdir_out("\\%c",s[i]);
+            else if(s[i] < 0x20 || s[i] > 0x7E) lifdir_out("\\u%04x",s[i]);
+            else lifdir_out_bytes(s+i,1);
+          }
+        else
+          {
+            if(s[i]=='"') lifdir_out("\"\"");
+            else lifdir_out_bytes(s+i,1);
+          }
+      }
+    lifdir_out("\"");
+  }
 
-    /* output date and time */
-    for (i=0; i<6; i++) 
+void lifdir_full_header(int watch)
+  {
+    if(watch) lifdir_out("event,");
+    lifdir_out("entry,name,type,type_code,known_type,length,start_block,blocks,date,implementation,decoder\n");
+  }
+
+void lifdir_full_dir_entry(struct lifdir_entry *e, int json, char *event)
+  {
+    /* Output all decoded fields of a directory entry either as one
+       line of quoted csv or as one JSON object. In watch mode event
+       is the kind of change, otherwise NULL */
+    unsigned char *entry;
+    const struct lif_filetype *t;
+    char file_type[10];
+    int length, known_type, i;
+    char *null_str;
+
+    entry=e->data;
+    length=file_length_type_check(entry,file_type,&known_type);
+    t=lif_filetype_by_code(get_lif_int(entry+10,2));
+    null_str= json ? "null" : "";
+
+    if(json)
+      {
+        lifdir_out("{");
+        if(event != (char *) NULL) lifdir_out("\"event\":\"%s\",",event);
+        lifdir_out("\"entry\":%d,\"name\":",e->index);
+      }
+    else
       {
-	 printf("%c",SEP);
-         printf("%d",bcd_to_dec(*(entry+20+i)));
+        if(event != (char *) NULL) lifdir_out("%s,",event);
+        lifdir_out("%d,",e->index);
       }
+    lifdir_quoted(entry,lifdir_name_length(entry),json);
 
-    /* output the impelentation bytes */
+    if(json) lifdir_out(",\"type\":");
+    else lifdir_out(",");
+    lifdir_quoted((unsigned char *) file_type,strlen(file_type),json);
+
+    if(json)
+      {
+        lifdir_out(",\"type_code\":%d,\"known_type\":%s,\"length\":%d,\"start_block\":%d,\"blocks\":%d,\"date\":",
+           get_lif_int(entry+10,2),known_type ? "true" : "false",length,
+           get_lif_int(entry+12,4),get_lif_int(entry+16,4));
+      }
+    else
+      {
+        lifdir_out(",%d,%d,%d,%d,%d,",get_lif_int(entry+10,2),known_type,
+           length,get_lif_int(entry+12,4),get_lif_int(entry+16,4));
+      }
+
+    /* If the month is not 0, it's a valid date */
+    if(*(entry+21))
+      {
+        if(json) lifdir_out("\"");
+        lifdir_out_iso_date(entry+20);
+        if(json) lifdir_out("\"");
+      }
+    else lifdir_out("%s",null_str);
+
+    if(json) lifdir_out(",\"implementation\":\"");
+    else lifdir_out(",");
     for(i=0; i<6; i++)
       {
-         printf("%c",SEP);
-         printf("%d",get_lif_int(entry+26+i,1));
+         lifdir_out("%02X",*(entry+26+i));
+      }
+    if(json) lifdir_out("\",\"decoder\":");
+    else lifdir_out(",");
+    if(t != (struct lif_filetype *) NULL && t->decoder != (char *) NULL)
+      {
+        lifdir_quoted((unsigned char *) t->decoder,strlen(t->decoder),json);
+      }
+    else lifdir_out("%s",null_str);
+    lifdir_out(json ? "}\n" : "\n");
+  }
+
+static int lifdir_date_key(unsigned char *entry)
+  {
+    /* time stamp as a sortable number, files without a date sort first */
+    unsigned char *date;
+
+    if(*(entry+21) == 0) return(0);
+    date=entry+20;
+    return(((((lifdir_year(date)*13 + bcd_to_dec(*(date+MONTH_OFF)))*32 +
+           bcd_to_dec(*(date+DAY_OFF)))*24 + bcd_to_dec(*(date+HOUR_OFF)))*60 +
+           bcd_to_dec(*(date+MINUTE_OFF)))*60 + bcd_to_dec(*(date+SECOND_OFF)));
+  }
+
+static int lifdir_compare(const void *p1, const void *p2)
+  {
+    const struct lifdir_entry *e1= p1;
+    const struct lifdir_entry *e2= p2;
+    int k1, k2;
+
+    switch(sort_key)
+      {
+        case SORT_NAME:
+          k1=memcmp(e1->data,e2->data,NAME_LEN);
+          k2=0;
+          break;
+        case SORT_SIZE:
+          k1=file_length((unsigned char *) e1->data,NULL);
+          k2=file_length((unsigned char *) e2->data,NULL);
+          break;
+        case SORT_START:
+          k1=get_lif_int((unsigned char *) e1->data+12,4);
+          k2=get_lif_int((unsigned char *) e2->data+12,4);
+          break;
+        case SORT_DATE:
+          k1=lifdir_date_key((unsigned char *) e1->data);
+          k2=lifdir_date_key((unsigned char *) e2->data);
+          break;
+        default:
+          k1=k2=0;
+          break;
+      }
+    if(k1 < k2) return(-1);
+    if(k1 > k2) return(1);
+    /* keep directory order for equal keys */
+    return(e1->index - e2->index);
+  }
+
+static void lifdir_output_entry(struct lifdir_entry *e, int format, int verbosity, char *event)
+  {
+    /* output a directory entry in the selected format. In watch mode
+       event is the kind of change, otherwise NULL */
+    switch(format)
+      {
+        case FMT_CSV_OLD:
+          if(event != (char *) NULL) lifdir_out("%s%c",event,SEP);
+          lifdir_csv_dir_entry(e->data);
+          break;
+        case FMT_CSV:
+          lifdir_full_dir_entry(e,0,event);
+          break;
+        case FMT_JSON:
+          lifdir_full_dir_entry(e,1,event);
+          break;
+        default:
+          if(event != (char *) NULL) lifdir_out("%-8s",event);
+          lifdir_print_dir_entry(e->data,verbosity);
+          break;
+      }
+  }
+
+static int lifdir_scan(int input_device, unsigned int dir_start, unsigned int dir_length,
+                       struct lifdir_entry *entries, unsigned int *last_block)
+  {
+    /* read the valid directory entries into entries, which must have room
+       for 8*dir_length entries. Return the number of files */
+    unsigned char data[SECTOR_SIZE]; /* buffer to hold current block */
+    unsigned int num_files; /* number of files on medium */
+    unsigned int dir_end; /* Set at end of directory */
+    unsigned int dir_entry; /* Directory entry within current block */
+    unsigned int dir_block; /* Current block offset from start of directory */
+    unsigned int file_type; /* File type word */
+    unsigned int file_start;
+    unsigned int file_len;
+
+    *last_block=0;
+    num_files=0;
+    for(dir_block=0; dir_block<dir_length; dir_block++)
+      {
+         dir_end=0;
+         lif_read_block(input_device,dir_block+dir_start,data);
+         for(dir_entry=0; dir_entry<8; dir_entry++)
+           {
+             file_type=get_lif_int((data+(dir_entry<<5)+10),2);
+             if(file_type==0) { continue; } /* Skip over deleted files */
+             if(file_type==0xffff)
+               {
+                 /* This is the end of the directory */
+                 dir_end=1;
+                 break;
+               }
+            entries[num_files].index=dir_block*8+dir_entry;
+            memcpy(entries[num_files].data,data+(dir_entry<<5),ENTRY_SIZE);
+            file_start=get_lif_int(data+(dir_entry<<5)+12,4);
+            file_len=get_lif_int(data+(dir_entry<<5)+16,4);
+            /* update last used block */
+            *last_block=file_start+file_len-1;
+            num_files++;
+           }
+         if(dir_end) { break; } /* Quit at end of directory */
+      }
+    return(num_files);
+  }
+
+#ifdef HAVE_INOTIFY
+static int lifdir_watch_init(char *filename, char **base)
+  {
+    /* watch the directory that contains the image file. This catches
+       in place modifications as well as a replaced image file and the
+       journal of a transaction */
+    int fd;
+    char *dir, *p;
+
+    fd=inotify_init();
+    if(fd == -1) return(-1);
+    dir=strdup(filename);
+    if(dir == (char *) NULL) return(-1);
+    p=strrchr(dir,'/');
+    if(p == (char *) NULL)
+      {
+        *base=filename;
+        strcpy(dir,".");
+      }
+    else
+      {
+        *base=filename+(p-dir)+1;
+        if(p == dir) p++;
+        *p='\0';
+      }
+    if(inotify_add_watch(fd,dir,IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE)== -1)
+      {
+        free(dir);
+        close(fd);
+        return(-1);
+      }
+    free(dir);
+    return(fd);
+  }
+
+static void lifdir_watch_wait(int fd, char *base)
+  {
+    /* wait until the image file or its journal were changed and no
+       further changes arrive for WATCH_SETTLE_MS */
+    char buf[4096];
+    struct inotify_event *ev;
+    struct pollfd pfd;
+    ssize_t n;
+    char *p;
+    int changed, len;
+
+    len=strlen(base);
+    changed=0;
+    pfd.fd=fd;
+    pfd.events=POLLIN;
+    while(1)
+      {
+        if(poll(&pfd,1,changed ? WATCH_SETTLE_MS : -1) == 0) return;
+        n=read(fd,buf,sizeof(buf));
+        if(n <= 0) continue;
+        for(p=buf; p < buf+n; p+=sizeof(struct inotify_event)+ev->len)
+          {
+            ev= (struct inotify_event *) p;
+            if(ev->len == 0) continue;
+            if(strncmp(ev->name,base,len) != 0) continue;
+            if(ev->name[len]=='\0' || strcmp(ev->name+len,".journal")==0) changed=1;
+          }
+      }
+  }
+#else
+static void lifdir_watch_wait(char *filename)
+  {
+    /* no change notification available, poll the modification time
+       of the image file */
+    struct stat st;
+    time_t mtime;
+    off_t size;
+
+    mtime=0;
+    size=0;
+    if(stat(filename,&st)==0)
+      {
+        mtime=st.st_mtime;
+        size=st.st_size;
+      }
+    while(1)
+      {
+#ifdef _WIN32
+        Sleep(1000);
+#else
+        sleep(1);
+#endif
+        if(stat(filename,&st) != 0) continue;
+        if(st.st_mtime != mtime || st.st_size != size) return;
+      }
+  }
+#endif
+
+static int lifdir_find(struct lifdir_entry *entries, int num_files, unsigned char *name)
+  {
+    /* find a file by name, return -1 if not found */
+    int i;
+
+    for(i=0; i<num_files; i++)
+      {
+        if(memcmp(entries[i].data,name,NAME_LEN)==0) return(i);
+      }
+    return(-1);
+  }
+
+static int lifdir_watch(char *filename, int format, int verbosity,
+                        struct lifdir_entry *entries, int num_files)
+  {
+    /* wait for changes of the image file and output the added, removed
+       and changed directory entries. Only block 0 and the directory are
+       read again. This function does not return */
+    int input_device;
+    unsigned char data[SECTOR_SIZE];
+    unsigned int dir_start, dir_length, last_block;
+    struct lifdir_entry *new_entries, *e;
+    int new_files, i, j;
+    char *image;
+#ifdef HAVE_INOTIFY
+    int fd;
+    char *base;
+#endif
+
+    /* events refer to the image file without a backend prefix */
+    image=lif_image_name(filename);
+#ifdef HAVE_INOTIFY
+    fd=lifdir_watch_init(image,&base);
+    if(fd == -1)
+      {
+        fprintf(stderr,"Cannot watch %s (%s)\n",image,strerror(errno));
+        return(RETURN_ERROR);
       }
-    printf("\n");
-  } 
+#endif
+
+    while(1)
+      {
+#ifdef HAVE_INOTIFY
+        lifdir_watch_wait(fd,base);
+#else
+        lifdir_watch_wait(image);
+#endif
+        /* the image file may have been replaced, so open it again */
+        if((input_device=lif_open(filename,O_RDONLY | O_BINARY,0,0))==-1) continue;
+        if(lif_num_blocks(input_device) < 1)
+          {
+            lif_close(input_device);
+            continue;
+          }
+        lif_read_block(input_device,0,data);
+        if(get_lif_int(data+0,2)!=0x8000)
+          {
+            fprintf(stderr,"This is not a LIF disk!\n");
+            lif_close(input_device);
+            continue;
+          }
+        dir_start=get_lif_int((data+8),4);
+        dir_length=get_lif_int((data+16),4);
+        if(dir_start+dir_length > (unsigned int) lif_num_blocks(input_device))
+          {
+            lif_close(input_device);
+            continue;
+          }
+        new_entries= malloc(8*dir_length*sizeof(struct lifdir_entry)+1);
+        if(new_entries == (struct lifdir_entry *) NULL)
+          {
+            fprintf(stderr,"cannot allocate directory buffer\n");
+            exit(EXIT_ERROR);
+          }
+        new_files=lifdir_scan(input_device,dir_start,dir_length,new_entries,&last_block);
+        lif_close(input_device);
+
+        /* compare both directories, a file is identified by its name */
+        outbuf_len=0;
+        for(i=0; i<num_files; i++)
+          {
+            if(lifdir_find(new_entries,new_files,entries[i].data) == -1)
+              {
+                lifdir_output_entry(&entries[i],format,verbosity,"removed");
+              }
+          }
+        for(i=0; i<new_files; i++)
+          {
+            e= &new_entries[i];
+            j=lifdir_find(entries,num_files,e->data);
+            if(j == -1)
+              {
+                lifdir_output_entry(e,format,verbosity,"added");
+              }
+            else if(memcmp(entries[j].data,e->data,ENTRY_SIZE) != 0 ||
+                    entries[j].index != e->index)
+              {
+                lifdir_output_entry(e,format,verbosity,"changed");
+              }
+          }
+        fwrite(outbuf,sizeof(char),outbuf_len,stdout);
+        fflush(stdout);
+        free(entries);
+        entries=new_entries;
+        num_files=new_files;
+      }
+    return(RETURN_OK);
+  }
 
 void lifdir_usage(void)
   {
-     fprintf(stderr,"Usage : lifutils lifdir [-n] [-v l] [-c] [-p] LIFIMAGEFILE [> output file]\n");
+     fprintf(stderr,"Usage : lifutils lifdir [-n] [-v l] [-c] [-f format] [-s key] [-w] [-p] LIFIMAGEFILE [> output file]\n");
      fprintf(stderr,"        Display the directory of a LIF image file\n");
      fprintf(stderr,"        -n flag to display file names only\n");
      fprintf(stderr,"        -v l verbosity level\n");
@@ -131,8 +649,14 @@ void lifdir_usage(void)
      fprintf(stderr,"              implementation bytes to directory listing\n");
      fprintf(stderr,"        -c output all directory information as csv,\n");
      fprintf(stderr,"           see program documentation for details.\n");
-     fprintf(stderr,"           Note: verbosity level and csv output options are\n");
+     fprintf(stderr,"        -f format output all decoded directory information\n");
+     fprintf(stderr,"           csv:  quoted csv with a header line\n");
+     fprintf(stderr,"           json: one JSON object per line\n");
+     fprintf(stderr,"           Note: verbosity level, -c and -f options are\n");
      fprintf(stderr,"           mutually exclusive.\n");
+     fprintf(stderr,"        -s key sort the directory by name, size, start or date\n");
+     fprintf(stderr,"        -w watch the LIF image file and output added, removed and\n");
+     fprintf(stderr,"           changed directory entries until interrupted\n");
      fprintf(stderr,"        -p Show directory info of LIF file system on a floppy disk.\n");
      fprintf(stderr,"           Note: this option is only supported on LINUX.\n");
      fprintf(stderr,"           Specify the floppy device instead of the lif-image-filename.\n");
@@ -146,11 +670,15 @@ int lifdir(int argc, char **argv)
     int option; /* Command line option character */
     int input_device; /* Input file or device descriptor */
     int verbosity;    /* extent of information */
-    int csv_flag;     /* csv output */
+    int format;       /* output format */
     int physical_flag; /* pyhsical disk access flag */
+    int watch_flag; /* watch for changes */
     char *snum_verbosity= (char *) NULL; /* arg to -v option */
+    char *format_str= (char *) NULL; /* arg to -f option */
+    char *sort_str= (char *) NULL; /* arg to -s option */
     int i; /* General index counter */
     unsigned char data[SECTOR_SIZE]; /* buffer to hold current block */
+    struct lifdir_entry *entries; /* valid directory entries */
 
     /* LIF disk values */
     unsigned int dir_start; /* first block of directory */
@@ -162,24 +690,15 @@ int lifdir(int argc, char **argv)
     unsigned int totalsize; /* size of medium in blocks */
     unsigned int num_files; /* number of files on medium */
 
-
-    /* Directory search values */
-    unsigned int dir_end; /* Set at end of directory */
-    unsigned int dir_entry; /* Directory entry within current block */
-    unsigned int dir_block; /* Current block offset from start of directory */
-    unsigned int file_type; /* File type word */
-
-    /* file specific values */
-    unsigned int file_start;
-    unsigned int file_len;
-
     totalsize=0;
     /* process command line options */
     optind=1;
     physical_flag=0;
+    watch_flag=0;
     verbosity=-1;
-    csv_flag=0;
-    while((option=getopt(argc,argv,"v:npc?"))!=-1)
+    format=FMT_LIST;
+    sort_key=SORT_NONE;
+    while((option=getopt(argc,argv,"v:npcf:s:w?"))!=-1)
       {
         switch(option)
           {
@@ -189,7 +708,13 @@ int lifdir(int argc, char **argv)
                         break;
              case 'p' : physical_flag=1;
                         break;
-             case 'c' : csv_flag=1;
+             case 'c' : format=FMT_CSV_OLD;
+                        break;
+             case 'f' : format_str=optarg;
+                        break;
+             case 's' : sort_str=optarg;
+                        break;
+             case 'w' : watch_flag=1;
                         break;
              case '?' : lifdir_usage();
                         return(RETURN_OK);
@@ -215,18 +740,50 @@ int lifdir(int argc, char **argv)
        }
     }
 
-    /* error if verbosity and csv specified */
-    if (csv_flag == 1 && verbosity != -1) {
+    /* get output format */
+    if (format_str != (char *) NULL) {
+       if (format != FMT_LIST) {
+          lifdir_usage();
+          return(RETURN_ERROR);
+       }
+       if (strcmp(format_str,"csv")==0) format=FMT_CSV;
+       else if (strcmp(format_str,"json")==0) format=FMT_JSON;
+       else {
+          lifdir_usage();
+          return(RETURN_ERROR);
+       }
+    }
+
+    /* get sort key */
+    if (sort_str != (char *) NULL) {
+       if (strcmp(sort_str,"name")==0) sort_key=SORT_NAME;
+       else if (strcmp(sort_str,"size")==0) sort_key=SORT_SIZE;
+       else if (strcmp(sort_str,"start")==0) sort_key=SORT_START;
+       else if (strcmp(sort_str,"date")==0) sort_key=SORT_DATE;
+       else {
+          lifdir_usage();
+          return(RETURN_ERROR);
+       }
+    }
+
+    /* a floppy disk or standard input cannot be watched */
+    if (watch_flag && (physical_flag || lif_image_name(argv[argc-1]) == (char *) NULL)) {
+       lifdir_usage();
+       return(RETURN_ERROR);
+    }
+
+    /* error if verbosity and csv or json specified */
+    if (format != FMT_LIST && verbosity != -1) {
        lifdir_usage();
        return(RETURN_ERROR);
     }
 
     /* set default verbodity level if not specified or csv */
     if (verbosity == -1) {
-       if (csv_flag == 1) verbosity=0;
+       if (format != FMT_LIST) verbosity=0;
        else verbosity=1;
     }
-    
+
     /* open input device */
     if((input_device=lif_open(argv[argc-1],O_RDONLY | O_BINARY,0,physical_flag))==-1)
       {
@@ -243,86 +800,87 @@ int lifdir(int argc, char **argv)
         fprintf(stderr,"This is not a LIF disk!\n");
         return(RETURN_ERROR);
       }
-    if(verbosity > 0) 
+
+    outbuf_size=OUTBUF_SIZE;
+    outbuf_len=0;
+    outbuf=malloc(outbuf_size);
+    if(outbuf == (char *) NULL)
+      {
+        fprintf(stderr,"cannot allocate output buffer\n");
+        return(RETURN_ERROR);
+      }
+
+    if(verbosity > 0)
       {
-       printf("Volume : ");
+       lifdir_out("Volume : ");
        if((*(data+2))!=' ')
        {
            /* There is a volume label */
-           for(i=2; i<8; i++)
-             {
-               putchar(*(data+i));
-             }
-           printf(" ");
+           lifdir_out_bytes(data+2,LABEL_LEN);
+           lifdir_out(" ");
           }
 
         /* If the time stamp month is non-zero, print the time stamp */
        if(*(data+37))
          {
-           printf(", formatted : "); 
-           print_date(data+36);
+           lifdir_out(", formatted : ");
+           lifdir_out_date(data+36);
          }
-       printf("\n");
+       lifdir_out("\n");
       /* Print volume size */
       tracks=get_lif_int(data+24,4);
       surfaces=get_lif_int(data+28,4);
       blocks=get_lif_int(data+32,4);
       totalsize= tracks*surfaces*blocks;
-      printf("Tracks: %d Surfaces: %d Blocks/Track: %d",tracks,surfaces,blocks);
+      lifdir_out("Tracks: %d Surfaces: %d Blocks/Track: %d",tracks,surfaces,blocks);
       if(totalsize==0 || blocks == 0x9a009a0)
       {
-         printf(".\nWarning the medium was not initialized properly!\n");
+         lifdir_out(".\nWarning the medium was not initialized properly!\n");
       } else {
-         printf(" Total size: %d Blocks, %d Bytes\n",totalsize,totalsize*256);
+         lifdir_out(" Total size: %d Blocks, %d Bytes\n",totalsize,totalsize*256);
       }
     }
 
     /* Find where the directory is */
     dir_start=get_lif_int((data+8),4);
     dir_length=get_lif_int((data+16),4);
-    last_block=0;
+    entries= malloc(8*dir_length*sizeof(struct lifdir_entry)+1);
+    if(entries == (struct lifdir_entry *) NULL)
+      {
+        fprintf(stderr,"cannot allocate directory buffer\n");
+        free(outbuf);
+        return(RETURN_ERROR);
+      }
 
     /* Now scan the directory */
-    num_files=0;
-    for(dir_block=0; dir_block<dir_length; dir_block++)
+    num_files=lifdir_scan(input_device,dir_start,dir_length,entries,&last_block);
+    lif_close(input_device);
+
+    /* sort and output the directory entries */
+    if(sort_key != SORT_NONE)
       {
-         dir_end=0;
-         lif_read_block(input_device,dir_block+dir_start,data);
-         for(dir_entry=0; dir_entry<8; dir_entry++)
-           {
-             file_type=get_lif_int((data+(dir_entry<<5)+10),2);
-             if(file_type==0) { continue; } /* Skip over deleted files */
-             if(file_type==0xffff)
-               {
-                 /* This is the end of the directory */
-                 dir_end=1;
-                 break;
-               }
-	    if ( csv_flag) 
-	      {
-                 lifdir_csv_dir_entry(data+(dir_entry<<5));
-	      }
-	    else
-	      {
-                 lifdir_print_dir_entry(data+(dir_entry<<5),verbosity);
-	      }
-            file_start=get_lif_int(data+(dir_entry<<5)+12,4);
-            file_len=get_lif_int(data+(dir_entry<<5)+16,4);
-            /* update last used block */
-            last_block=file_start+file_len-1;
-            num_files++;
-           }
-         if(dir_end) { break; } /* Quit at end of directory */
+        qsort(entries,num_files,sizeof(struct lifdir_entry),lifdir_compare);
+      }
+    if(format == FMT_CSV) lifdir_full_header(watch_flag);
+    for(i=0; i< (int) num_files; i++)
+      {
+        lifdir_output_entry(&entries[i],format,verbosity,watch_flag ? "listed" : (char *) NULL);
       }
-    lif_close(input_device);
     if(verbosity > 0) {
-       printf("%d files (%d max), ",num_files,dir_length*8);
+       lifdir_out("%d files (%d max), ",num_files,dir_length*8);
        if(last_block > 0) {
-          printf("last block used: %d (%d max)\n",last_block,totalsize);
+          lifdir_out("last block used: %d (%d max)\n",last_block,totalsize);
        } else {
-          printf("last block used: none (%d max)\n",totalsize);
+          lifdir_out("last block used: none (%d max)\n",totalsize);
        }
     }
+    fwrite(outbuf,sizeof(char),outbuf_len,stdout);
+    if(watch_flag)
+      {
+        fflush(stdout);
+        return(lifdir_watch(argv[argc-1],format,verbosity,entries,num_files));
+      }
+    free(entries);
+    free(outbuf);
     return(RETURN_ERROR);
   }
-
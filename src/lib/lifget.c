@@ -8,6 +8,7 @@
 #include "lifutils.h"
 #include"lif_block.h"
 #include"lif_dir_utils.h"
+#include "lif_stats.h"
 #include "lif_const.h"
 
 
@@ -33,30 +34,10 @@ void lifget_file_copy(int input_device, FILE* output_file,
                int start, int length)
   {
     /* Copy length bytes starting at block start from LIF input_device
-       to output_file */
+       to output_file. The data is moved by the kernel if possible */
   
-    unsigned int complete_blocks; /* Number of complete blocks to copy */
-    unsigned int leftover_bytes; /* And the odd bytes on the end */
-    unsigned int block; /* Current block offset from start */
-    unsigned char data[SECTOR_SIZE];
-
-    complete_blocks=length/SECTOR_SIZE;
-    if(complete_blocks!=0)
-      {
-        /* Copy the complete blocks first */
-        for(block=0; block<complete_blocks; block++)
-          {
-            lif_read_block(input_device,start+block,data);
-            fwrite(data,sizeof(char),SECTOR_SIZE,output_file);
-          }
-      }
-    leftover_bytes=length%SECTOR_SIZE;
-    if(leftover_bytes!=0)
-      {
-        /* Odd bytes on the end -- read one more block */
-        lif_read_block(input_device,start+complete_blocks,data);
-        fwrite(data,sizeof(char),leftover_bytes,output_file);
-      }
+    fflush(output_file);
+    lif_copy_to_fd(input_device,start,length,_fileno(output_file));
   }
 
 int lifget(int argc, char **argv)
@@ -137,6 +118,7 @@ int lifget(int argc, char **argv)
 
 
     /* Now read block 0 to find where the directory is */
+    LIF_STATS_PHASE(LIF_PHASE_HEADER);
     lif_read_block(input_device,0,dir_data);
 
     /* Make sure it's a LIF disk */
@@ -154,6 +136,7 @@ int lifget(int argc, char **argv)
     pad_name(argv[optind+1],cmp_name);
 
     /* Scan the directory */
+    LIF_STATS_PHASE(LIF_PHASE_DIRECTORY);
     dir_end=0;
     found_file=0;
     for(dir_block=0; dir_block<dir_length; dir_block++)
@@ -215,9 +198,11 @@ int lifget(int argc, char **argv)
       }
 
     /* Actually copy the file */ 
+    LIF_STATS_PHASE(LIF_PHASE_COPY);
     lifget_file_copy(input_device,output_file,file_start,file_len);
 
     /* tidy up and quit */
+    LIF_STATS_PHASE(LIF_PHASE_OTHER);
     if(optind==argc-3)
       {
         fclose(output_file);
@@ -0,0 +1,143 @@
+/* lifjournal.c -- group modifications of a LIF image file into a transaction */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#include<stdio.h>
+#include<fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "lifutils.h"
+#include"lif_block.h"
+#include "lif_journal.h"
+#include"lif_dir_utils.h"
+#include "lif_const.h"
+
+#define DEBUG 0
+
+#define JOURNAL_STATUS 0
+#define JOURNAL_BEGIN 1
+#define JOURNAL_COMMIT 2
+#define JOURNAL_ABORT 3
+#define JOURNAL_DEFER 4
+#define JOURNAL_RECOVER 5
+
+void lifjournal_usage(void)
+  {
+    fprintf(stderr,"Usage : lifutils lifjournal [-b | -c | -n | -r | -a] LIFIMAGEFILE\n");
+    fprintf(stderr,"        Group modifications of a LIF image file into one transaction.\n");
+    fprintf(stderr,"        Without an option the state of the transaction is displayed.\n");
+    fprintf(stderr,"        -b Begin a transaction. All following modifications are\n");
+    fprintf(stderr,"           written to the journal file LIFIMAGEFILE.journal.\n");
+    fprintf(stderr,"        -c Commit the transaction and apply it to the image file.\n");
+    fprintf(stderr,"        -n Commit the transaction, but do not apply it to the image file.\n");
+    fprintf(stderr,"           It is applied the next time the image file is opened for\n");
+    fprintf(stderr,"           writing, like a commit that was interrupted.\n");
+    fprintf(stderr,"        -r Apply a committed transaction to the image file.\n");
+    fprintf(stderr,"        -a Abort the transaction, the image file remains unchanged.\n");
+    fprintf(stderr,"\n");
+  }
+
+int lifjournal(int argc, char **argv)
+  {
+    /* System variables */
+    int option; /* Command line option character */
+    int action; /* what to do */
+    int lif_device; /* Descriptor of LIF device */
+    unsigned char header[SECTOR_SIZE]; /* block 0 */
+
+    /* Process command line options */
+    optind=1;
+    action=JOURNAL_STATUS;
+    while ((option=getopt(argc,argv,"bcnra?"))!=-1)
+      {
+        switch(option)
+          {
+            case 'b' : action=JOURNAL_BEGIN;
+                       break;
+            case 'c' : action=JOURNAL_COMMIT;
+                       break;
+            case 'n' : action=JOURNAL_DEFER;
+                       break;
+            case 'r' : action=JOURNAL_RECOVER;
+                       break;
+            case 'a' : action=JOURNAL_ABORT;
+                       break;
+            case '?' : lifjournal_usage();
+                       return(RETURN_OK);
+          }
+      }
+
+    /* Are the right number of names specified ? */
+    if( optind != argc-1  )
+      {
+        lifjournal_usage();
+        return(RETURN_ERROR);
+      }
+
+    /* Open lif image file, a committed transaction is recovered here
+       unless the state is displayed */
+    if((lif_device=lif_open(argv[optind],(action == JOURNAL_STATUS ? O_RDONLY : O_RDWR) | O_BINARY,0,0))==-1)
+      {
+        fprintf(stderr,"Error opening %s\n",argv[optind]);
+        return(RETURN_ERROR);
+      }
+    lif_read_block(lif_device,0,header);
+    if(get_lif_int(header+0,2)!=0x8000)
+      {
+        fprintf(stderr,"This is not a LIF disk!\n");
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+
+    switch(action)
+      {
+        case JOURNAL_STATUS:
+          if(lif_journal_open_transaction())
+            {
+              printf("Transaction open, %d block(s) written\n",lif_journal_blocks());
+            }
+          else if(lif_journal_committed())
+            {
+              printf("Transaction committed, %d block(s) not applied\n",lif_journal_blocks());
+            }
+          else
+            {
+              printf("No transaction open\n");
+            }
+          break;
+
+        case JOURNAL_BEGIN:
+          if(lif_journal_begin())
+            {
+              fprintf(stderr,"A transaction is already open for %s\n",argv[optind]);
+              lif_close(lif_device);
+              return(RETURN_ERROR);
+            }
+          break;
+
+        case JOURNAL_COMMIT:
+        case JOURNAL_DEFER:
+          if(lif_journal_commit(lif_device,action == JOURNAL_COMMIT))
+            {
+              fprintf(stderr,"No transaction open for %s\n",argv[optind]);
+              lif_close(lif_device);
+              return(RETURN_ERROR);
+            }
+          break;
+
+        case JOURNAL_RECOVER:
+          /* done by lif_open */
+          break;
+
+        case JOURNAL_ABORT:
+          if(lif_journal_abort())
+            {
+              fprintf(stderr,"No transaction open for %s\n",argv[optind]);
+              lif_close(lif_device);
+              return(RETURN_ERROR);
+            }
+          break;
+      }
+    lif_close(lif_device);
+    return(RETURN_OK);
+  }
@@ -35,6 +35,7 @@ int liflabel(int argc, char **argv)
     int clear_flag; /* Clear an existing label */
     int physical_flag; /* Option to use a physical device */
     int lif_device; /* Descriptor of input device */
+    FILE *msg_file; /* output of the label */
     char new_label[LABEL_LEN]; /* New label name */
     int i;
     
@@ -99,16 +100,17 @@ int liflabel(int argc, char **argv)
         return(RETURN_ERROR);
       }
 
-     /* Output label */
+     /* Output label, standard output may carry the image file */
+     msg_file= strcmp(argv[optind],"-")==0 ? stderr : stdout;
      if((*(dir_data+2))!=' ')
       {
         /* There is a volume label */
-        printf("Old Volume : ");
+        fprintf(msg_file,"Old Volume : ");
         for(i=2; i<8; i++)
           {
-            putchar(*(dir_data+i));
+            fputc(*(dir_data+i),msg_file);
           }
-        printf("\n");
+        fprintf(msg_file,"\n");
        }
 
      /* Clear Label */
@@ -123,12 +125,12 @@ int liflabel(int argc, char **argv)
           {
             *(dir_data+i)= new_label[i-2];
           }
-        printf("New Volume : ");
+        fprintf(msg_file,"New Volume : ");
         for(i=2; i<8; i++)
           {
-            putchar(*(dir_data+i));
+            fputc(*(dir_data+i),msg_file);
           }
-        printf("\n");
+        fprintf(msg_file,"\n");
         lif_write_block(lif_device,0,dir_data);
      }
     /* tidy up and quit */
@@ -12,6 +12,7 @@
 #include"lif_block.h"
 #include "lif_create_entry.h"
 #include"lif_dir_utils.h"
+#include "lif_stats.h"
 #include "lif_const.h"
 
 
@@ -20,8 +21,10 @@
 
 void lifpack_usage(void)
   {
-    fprintf(stderr,"Usage : lifutils lifpack [-p] LIFIMAGEGILE \n");
+    fprintf(stderr,"Usage : lifutils lifpack [-d] [-p] LIFIMAGEGILE \n");
     fprintf(stderr,"        Pack a LIF image file\n");
+    fprintf(stderr,"        -d Pack the directory only, remove deleted entries\n");
+    fprintf(stderr,"           without moving any file data.\n");
     fprintf(stderr,"        -p Pack a LIF file system on a floppy disk.\n");
     fprintf(stderr,"           Note: this option is only supported on LINUX.\n");
     fprintf(stderr,"           Specify the floppy device instead of the lif-image-filename.\n");
@@ -29,11 +32,51 @@ void lifpack_usage(void)
     fprintf(stderr,"\n");
 }
 
+static int lifpack_dir_only(int lif_device, int dir_start, int dir_length)
+  {
+    /* Squeeze out deleted entries and move the end of directory mark up.
+       Only the directory sectors whose content changed are written */
+    unsigned char *old_dir; /* directory as read */
+    unsigned char *new_dir; /* packed directory */
+    int dir_entry, new_entry, file_type, i;
+
+    old_dir= malloc(dir_length*SECTOR_SIZE);
+    new_dir= malloc(dir_length*SECTOR_SIZE);
+    if(old_dir == NULL || new_dir == NULL) {
+       fprintf(stderr,"Cannot allocate memory\n");
+       exit(1);
+    }
+    for(i=0;i<dir_length;i++) lif_read_block(lif_device,dir_start+i,old_dir+i*SECTOR_SIZE);
+
+    memset(new_dir,0xFF,dir_length*SECTOR_SIZE);
+    new_entry=0;
+    for(dir_entry=0;dir_entry<8*dir_length;dir_entry++) {
+       file_type=get_lif_int(old_dir+(dir_entry<<5)+10,2);
+       if(file_type==0) continue; /* Skip deleted files */
+       if(file_type==0xFFFF) break; /* End of directory */
+       memcpy(new_dir+(new_entry<<5),old_dir+(dir_entry<<5),ENTRY_SIZE);
+       new_entry++;
+    }
+    /* keep the old end of directory mark and everything behind it */
+    memcpy(new_dir+(dir_entry<<5),old_dir+(dir_entry<<5),(8*dir_length-dir_entry)*ENTRY_SIZE);
+
+    for(i=0;i<dir_length;i++) {
+       if(memcmp(old_dir+i*SECTOR_SIZE,new_dir+i*SECTOR_SIZE,SECTOR_SIZE)==0) continue;
+       debug_print("write directory block %d\n",dir_start+i);
+       lif_write_block(lif_device,dir_start+i,new_dir+i*SECTOR_SIZE);
+    }
+    debug_print("%d entries removed\n",dir_entry-new_entry);
+    free(old_dir);
+    free(new_dir);
+    return(RETURN_OK);
+  }
+
 int lifpack(int argc, char **argv)
   {
     /* System variables */
     int option; /* Command line option character */
     int physical_flag; /*  Option to use a physical device */
+    int dir_only_flag; /* Option to pack the directory only */
     int lif_device; /* Descriptor of input device */
     int i,j;
     
@@ -69,10 +112,13 @@ int lifpack(int argc, char **argv)
     /* Process command line options */
     optind=1;
     physical_flag=0;
-    while ((option=getopt(argc,argv,"p?"))!=-1)
+    dir_only_flag=0;
+    while ((option=getopt(argc,argv,"dp?"))!=-1)
       {
         switch(option)
           {
+            case 'd' : dir_only_flag=1;
+                       break;
             case 'p' : physical_flag=1;
                        break;
             case '?' : lifpack_usage();
@@ -97,6 +143,7 @@ int lifpack(int argc, char **argv)
       }
 
     /* Now read block 0 to find where the directory is */
+    LIF_STATS_PHASE(LIF_PHASE_HEADER);
     reccount=0;
     blocks[reccount]=malloc(sizeof (unsigned char) * SECTOR_SIZE);
     blockmap[reccount]=reccount;
@@ -113,6 +160,15 @@ int lifpack(int argc, char **argv)
     dir_start=get_lif_int(blocks[0]+8,4);
     dir_length=get_lif_int(blocks[0]+16,4);
 
+    /* pack the directory only */
+    if(dir_only_flag) {
+       LIF_STATS_PHASE(LIF_PHASE_COMMIT);
+       lifpack_dir_only(lif_device,dir_start,dir_length);
+       free(blocks[0]);
+       lif_close(lif_device);
+       return(RETURN_OK);
+    }
+
     /* get medium information */
     no_tracks=get_lif_int(blocks[0]+24,4);
     no_surfaces=get_lif_int(blocks[0]+28,4);
@@ -142,6 +198,7 @@ int lifpack(int argc, char **argv)
     }
 
     /* Scan the directory, buffer in directory entries  */
+    LIF_STATS_PHASE(LIF_PHASE_DIRECTORY);
     dir_end=0;
     new_entry=0;
     new_block_count=dir_start+dir_length;
@@ -194,6 +251,7 @@ int lifpack(int argc, char **argv)
       }
 
      /* read in all file blocks */
+     LIF_STATS_PHASE(LIF_PHASE_COPY);
      for(i=0;i<MAXBLOCKS;i++) {
        if(allocmap[i]==1) {
           blocks[i]= malloc(BLOCK_SIZE*sizeof(unsigned char));
@@ -202,7 +260,8 @@ int lifpack(int argc, char **argv)
        }
      }
 
-     /* truncate lif file */
+     /* truncate lif file and write the packed medium */
+     LIF_STATS_PHASE(LIF_PHASE_COMMIT);
      lif_truncate(lif_device);
      /* write all blocks of packed file */
      for(i=0;i<MAXBLOCKS;i++) {
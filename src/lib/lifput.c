@@ -6,27 +6,35 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/stat.h>
 #include "config.h"
 #include "lifutils.h"
 #include"lif_block.h"
 #include"lif_dir_utils.h"
 #include "lif_create_entry.h"
+#include "lif_stats.h"
 #include "lif_const.h"
 
 
 #define DEBUG 0
 
+/* return value of lifput_stat_input if the input is not a regular file */
+#define NOT_REGULAR -2
+
 #define filelength_in_blocks(i) \
    i/SECTOR_SIZE + (int) ((i % SECTOR_SIZE) != 0) 
 
 
 void lifput_usage(void)
   {
-    fprintf(stderr,"Usage : lifutils lifput [-l] [-p] LIFIMAGEFILE FILENAME\n");
+    fprintf(stderr,"Usage : lifutils lifput [-l] [-r] [-p] LIFIMAGEFILE FILENAME\n");
     fprintf(stderr,"        or\n");
-    fprintf(stderr,"        lifutils lifput [-l] [-p] LIFIMAGEFILE < input file\n");
+    fprintf(stderr,"        lifutils lifput [-l] [-r] [-p] LIFIMAGEFILE < input file\n");
     fprintf(stderr,"        Put a LIF file into a LIF image file\n");
     fprintf(stderr,"        -l Relax file name checking, allow underscores in file names.\n");
+    fprintf(stderr,"        -r Replace an existing file of the same name. The file is\n");
+    fprintf(stderr,"           written to free space and the entry is switched to it. Only\n");
+    fprintf(stderr,"           if there is no room, the old file is overwritten in place.\n");
     fprintf(stderr,"        -p Write file to a floppy disk with a LIF file system.\n");
     fprintf(stderr,"           Note: this option is only supported on LINUX.\n");
     fprintf(stderr,"           Specify the floppy device instead of the lif-image-filename.\n");
@@ -76,16 +84,67 @@ int lifput_read_input(FILE *fp, unsigned char **input_buffer,int num_blocks)
     return(bytes_read);
   }
 
-void lifput_file_copy(int output_device, unsigned char * input_buffer, int start, int num_blocks)
+int lifput_stat_input(FILE *fp, long data_offset, int num_blocks)
+  {
+    /* If the input is a regular file, check its length without reading it.
+       Return the number of data bytes, RETURN_ERROR if the length does not
+       match the directory entry or NOT_REGULAR if the input has to be
+       read into a buffer */
+    struct stat st;
+    long bytes_read, padded_size;
+
+    if(data_offset < 0) return(NOT_REGULAR);
+    if(fstat(_fileno(fp),&st)!=0) return(NOT_REGULAR);
+    if(! S_ISREG(st.st_mode)) return(NOT_REGULAR);
+
+    padded_size=num_blocks*SECTOR_SIZE;
+    bytes_read=(long) st.st_size - data_offset;
+    debug_print("regular input file, %ld data bytes\n",bytes_read);
+    if(bytes_read > padded_size) {
+        fprintf(stderr,"input file too large\n");
+        return(RETURN_ERROR);
+    }
+    if(bytes_read < padded_size - SECTOR_SIZE) {
+        fprintf(stderr,"premature end of input file\n");
+        return(RETURN_ERROR);
+    }
+    return((int) bytes_read);
+  }
+
+void lifput_file_copy(int output_device, unsigned char * input_buffer, 
+               FILE *input_file, long data_offset, int bytes_read,
+               int start, int num_blocks)
   {
-    /* Copy from buffer to output_file */
+    /* Copy from buffer to output_file. If there is no buffer, the complete
+       blocks are copied from the input file by the kernel. The last partial
+       block and missing blocks are padded with zeros */
   
-    int block,byte_counter;
+    int block,byte_counter,full_blocks,leftover_bytes;
+    unsigned char record[SECTOR_SIZE];
 
-    byte_counter=0;
-    for(block=0; block<num_blocks; block++) {
-       lif_write_block(output_device,start+block,input_buffer+byte_counter);
-       byte_counter+= SECTOR_SIZE;
+    if(input_buffer != (unsigned char *) NULL) {
+       byte_counter=0;
+       for(block=0; block<num_blocks; block++) {
+          lif_write_block(output_device,start+block,input_buffer+byte_counter);
+          byte_counter+= SECTOR_SIZE;
+       }
+       return;
+    }
+    full_blocks=bytes_read/SECTOR_SIZE;
+    leftover_bytes=bytes_read%SECTOR_SIZE;
+    if(full_blocks > 0) {
+       lif_copy_from_fd(_fileno(input_file),data_offset,output_device,start,full_blocks);
+    }
+    for(block=full_blocks; block<num_blocks; block++) {
+       memset(record,0,SECTOR_SIZE);
+       if(block==full_blocks && leftover_bytes) {
+          fseek(input_file,data_offset+(long) full_blocks*SECTOR_SIZE,SEEK_SET);
+          if(fread(record,sizeof(unsigned char),leftover_bytes,input_file)!= (size_t) leftover_bytes) {
+             fprintf(stderr,"premature end of input file\n");
+             exit(1);
+          }
+       }
+       lif_write_block(output_device,start+block,record);
     }
   }
 
@@ -101,6 +160,7 @@ int lifput(int argc, char **argv)
     int num_blocks; /* size of input file in blocks */
     int physical_flag; /* Option to use a physical device */
     int lax; /* option to relax file name checking */
+    int replace; /* option to replace an existing file */
     struct blocktype {
        int startblock;
        int filelength;
@@ -110,10 +170,15 @@ int lifput(int argc, char **argv)
     int last_data_block; /* last data block in medium */
     int free_space; /* size of contiguous free blocks */
     int extend_dir;  /* flag if end of dir marker has to be moved */
+    int found_entry; /* directory entry of the file to replace */
+    int found_start; /* start block of the file to replace */
+    int found_blocks; /* number of blocks of the file to replace */
+    int next_start; /* start block of the file following the file to replace */
     int fbytes;  /* file length of current directory entry */
     int fblocks; /* file length in blocks of current directory entry */
     int fstart;  /* start block of file of current directory entry */
     int bytes_read; /* number of bytes read from input */
+    long data_offset; /* offset of the file data in the input file */
     int i,j,n,t;
 
     
@@ -141,8 +206,9 @@ int lifput(int argc, char **argv)
     /* Process command line options */
     physical_flag=0;
     lax=0;
+    replace=0;
     optind=1;
-    while ((option=getopt(argc,argv,"pl?"))!=-1)
+    while ((option=getopt(argc,argv,"plr?"))!=-1)
       {
         switch(option)
           {
@@ -152,6 +218,9 @@ int lifput(int argc, char **argv)
             case 'l' : lax=1;
                        break;
 
+            case 'r' : replace=1;
+                       break;
+
             case '?' : lifput_usage();
                        return(RETURN_OK);
           }
@@ -165,6 +234,13 @@ int lifput(int argc, char **argv)
         return(RETURN_ERROR);
       }
 
+    /* The image file and the LIF file cannot both come from standard input */
+    if( (optind == argc-1) && (strcmp(argv[optind],"-")==0) )
+      {
+        fprintf(stderr,"Specify the input file if the LIF image file is read from standard input\n");
+        return(RETURN_ERROR);
+      }
+
     /* Open output device */
     if((output_device=lif_open(argv[optind],O_RDWR| O_BINARY,0,physical_flag))==-1)
       {
@@ -173,6 +249,7 @@ int lifput(int argc, char **argv)
       }
 
     /* Now read block 0 to find where the directory is */
+    LIF_STATS_PHASE(LIF_PHASE_HEADER);
     lif_read_block(output_device,0,dir_data);
 
     /* Make sure it's a LIF disk */
@@ -201,6 +278,7 @@ int lifput(int argc, char **argv)
     debug_print("dir_start %d dir_length %d\n\n",dir_start,dir_length);
 
     /* open input file, if none specified use standard input */
+    LIF_STATS_PHASE(LIF_PHASE_OTHER);
     if ( optind == argc -2) {
        input_file= fopen(argv[optind+1],"rb");
        if (input_file == (FILE *) NULL ) {
@@ -231,7 +309,13 @@ int lifput(int argc, char **argv)
           return(RETURN_ERROR);
     }
 
-    bytes_read=lifput_read_input(input_file,&input_buffer,num_blocks);
+    /* a regular input file is copied directly, otherwise buffer it */
+    input_buffer= (unsigned char *) NULL;
+    data_offset=ftell(input_file);
+    bytes_read=lifput_stat_input(input_file,data_offset,num_blocks);
+    if(bytes_read== NOT_REGULAR) {
+       bytes_read=lifput_read_input(input_file,&input_buffer,num_blocks);
+    }
     if(bytes_read== RETURN_ERROR) {
        if(input_file!=stdin) fclose(stdin);
           return(RETURN_ERROR);
@@ -272,12 +356,13 @@ int lifput(int argc, char **argv)
 
     /* Scan the directory, look for free diretory entries and
        build block list */
+    LIF_STATS_PHASE(LIF_PHASE_DIRECTORY);
     dir_end=0;
     found_file=0;
     free_dir_entry=-1;
     dir_entry_count=0;
     blocklist_count=0;
-    blocklist= malloc(8*dir_length*sizeof(struct blocktype));
+    blocklist= malloc((8*dir_length+1)*sizeof(struct blocktype));
     extend_dir= FALSE;
     debug_print("%s\n","directory scan");
     for(dir_block=0; dir_block<dir_length; dir_block++)
@@ -314,10 +399,16 @@ int lifput(int argc, char **argv)
                blocklist[blocklist_count].filelength= fblocks;
                blocklist_count++;
 
-               if(compare_names((char *) dir_data+(dir_entry<<5),cmp_name)) {
-                   /* Found the file */
+               if(! found_file && compare_names((char *) dir_data+(dir_entry<<5),cmp_name)) {
+                   /* Found the file, take the first entry of that name
+                      like lifget and lifdir do */
                    found_file=1;
-                   break;
+                   if(! replace) break;
+                   /* remember the extent of the file to replace */
+                   found_entry=dir_entry_count;
+                   found_start=fstart;
+                   found_blocks=get_lif_int(dir_data+(dir_entry<<5)+16,4);
+                   debug_print("replace file at %d (%d blocks)\n",found_start,found_blocks);
                 }
             }
             dir_entry_count+=1;
@@ -325,7 +416,7 @@ int lifput(int argc, char **argv)
         if(dir_end) { break; }; /* Quit at end */
       }
 
-    if(found_file)
+    if(found_file && ! replace)
       {
         /* Give duplicate file error */
         fprintf(stderr,"Duplicate filename: ");
@@ -337,12 +428,13 @@ int lifput(int argc, char **argv)
       }
 
     /* insert pseudo file entry as end of file */
-    blocklist[blocklist_count].startblock= medium_size+1;
+    LIF_STATS_PHASE(LIF_PHASE_ALLOCATION);
+    blocklist[blocklist_count].startblock= medium_size;
     blocklist[blocklist_count].filelength=0;
     blocklist_count++;
 
     /* no free directory entry ? */
-    if (free_dir_entry == -1) {
+    if (free_dir_entry == -1 && ! found_file) {
       fprintf(stderr,"Directory full\n");
       free(blocklist);
       free(input_buffer);
@@ -367,7 +459,9 @@ int lifput(int argc, char **argv)
         debug_print("start %d length %d\n",blocklist[i].startblock, blocklist[i].filelength);
     debug_print("%s\n","");
 
-    /* find fist contigous block, which is large enough */
+    /* find fist contigous block, which is large enough. In replace mode
+       the blocks of the old file stay untouched until the directory entry
+       is switched to the new content */
     file_start=-1;
     last_data_block=dir_start+dir_length;
     for (i=0; i< blocklist_count; i++) {
@@ -379,6 +473,29 @@ int lifput(int argc, char **argv)
        }
        last_data_block= blocklist[i].startblock + blocklist[i].filelength;
     }
+
+    if(found_file) {
+       /* replace mode: as a last resort overwrite the old file in place if
+          the new content fits or the following blocks are free. The old
+          content is lost if the copy is interrupted */
+       if(file_start == -1) {
+          next_start= medium_size;
+          for (i=0; i< blocklist_count; i++) {
+             if(blocklist[i].startblock > found_start) {
+                next_start= blocklist[i].startblock;
+                break;
+             }
+          }
+          if(num_blocks <= found_blocks || found_start+num_blocks <= next_start) {
+             debug_print("%s\n","overwrite in place");
+             file_start= found_start;
+             free_space= next_start - found_start;
+          }
+       }
+       /* write the entry of the old file, never touch the end of dir mark */
+       free_dir_entry= found_entry;
+       extend_dir= FALSE;
+    }
     if ( file_start == -1 ) {
        fprintf(stderr,"No room\n");
        free(blocklist);
@@ -397,10 +514,13 @@ int lifput(int argc, char **argv)
 
     /* Actually copy the file */ 
     debug_print("%s\n","copy file");
-    lifput_file_copy(output_device,input_buffer,file_start,num_blocks);
+    LIF_STATS_PHASE(LIF_PHASE_COPY);
+    lifput_file_copy(output_device,input_buffer,input_file,data_offset,bytes_read,
+       file_start,num_blocks);
 
     /* write directory record */
     debug_print("%s\n","write directory");
+    LIF_STATS_PHASE(LIF_PHASE_COMMIT);
     lif_write_dir_entry(output_device,dir_start,free_dir_entry,new_dir_entry);
     if(extend_dir) {
        debug_print("%s\n","write end of directory mark");
@@ -411,6 +531,7 @@ int lifput(int argc, char **argv)
     }
 
     /* tidy up and quit */
+    LIF_STATS_PHASE(LIF_PHASE_OTHER);
     free(blocklist);
     free(input_buffer);
     if(input_file != stdin) fclose(input_file);
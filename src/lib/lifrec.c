@@ -0,0 +1,212 @@
+/* lifrec.c -- read or write records of a data file inside a LIF image file */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#include<stdio.h>
+#include<fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "lifutils.h"
+#include"lif_block.h"
+#include"lif_dir_utils.h"
+#include "lif_const.h"
+#include "lif_record.h"
+
+
+void lifrec_usage(void)
+  {
+    fprintf(stderr,"Usage : lifutils lifrec [-c count] [-w [-f]] [-l] [-p] LIFIMAGEFILE LIFFILENAME RECORD\n");
+    fprintf(stderr,"        or\n");
+    fprintf(stderr,"        lifutils lifrec -i [-l] [-p] LIFIMAGEFILE LIFFILENAME\n");
+    fprintf(stderr,"        Read or write records of a DAT71 or SDATA file in place.\n");
+    fprintf(stderr,"        Records are counted from 0. Raw records are written to\n");
+    fprintf(stderr,"        standard output.\n");
+    fprintf(stderr,"        -c count number of records to read or write (default 1)\n");
+    fprintf(stderr,"        -w Overwrite the records with data from standard input\n");
+    fprintf(stderr,"        -f Overwrite the records of a secured DAT71 file as well\n");
+    fprintf(stderr,"        -i Show the number of records and the record length\n");
+    fprintf(stderr,"        -l Relax file name checking, allow underscores in file names\n");
+    fprintf(stderr,"        -p Access a floppy disk with a LIF file system.\n");
+    fprintf(stderr,"           Note: this option is only supported on LINUX.\n");
+    fprintf(stderr,"           Specify the floppy device instead of the lif-image-filename.\n");
+    fprintf(stderr,"           See the LIFUTILS tutorial for details.\n");
+    fprintf(stderr,"\n");
+  }
+
+int lifrec(int argc, char **argv)
+  {
+    /* System variables */
+    int option; /* Command line option character */
+    int physical_flag; /* Option to use a physical device */
+    int lax; /* Option to relax file name checking */
+    int write_flag; /* Write records */
+    int force_flag; /* Write records of a secured file */
+    int info_flag; /* Show record layout */
+    int count; /* Number of records */
+    int first; /* First record */
+    int num_args; /* Number of required arguments */
+    int lif_device; /* Descriptor of LIF device */
+    char cmp_name[10]; /* File name to look for */
+    unsigned char entry[ENTRY_SIZE]; /* Directory entry of the file */
+    int record_length; /* Record length in bytes */
+    int num_records; /* Number of records of the file */
+    int length; /* Number of bytes to transfer */
+    int ret;
+    unsigned char *data;
+
+    /* Process command line options */
+    physical_flag=0;
+    lax=0;
+    write_flag=0;
+    force_flag=0;
+    info_flag=0;
+    count=1;
+
+    optind=1;
+    while ((option=getopt(argc,argv,"c:wfiplh?"))!=-1)
+      {
+        switch(option)
+          {
+            case 'c' : if(sscanf(optarg,"%d",&count)!=1 || count < 1)
+                         {
+                           fprintf(stderr,"Illegal record count\n");
+                           return(RETURN_ERROR);
+                         }
+                       break;
+            case 'w' : write_flag=1;
+                       break;
+            case 'f' : force_flag=1;
+                       break;
+            case 'i' : info_flag=1;
+                       break;
+            case 'p' : physical_flag=1;
+                       break;
+            case 'l' : lax=1;
+                       break;
+            case 'h' :
+            case '?' : lifrec_usage();
+                       return(RETURN_OK);
+          }
+      }
+
+    /* Are the right number of names specified ? */
+    num_args= info_flag ? 2 : 3;
+    if( optind != argc-num_args || (info_flag && write_flag) || (force_flag && ! write_flag))
+      {
+        lifrec_usage();
+        return(RETURN_ERROR);
+      }
+
+    /* Records to write and the image file cannot both come from standard input */
+    if(write_flag && strcmp(argv[optind],"-")==0)
+      {
+        fprintf(stderr,"Records cannot be written to a LIF image file read from standard input\n");
+        return(RETURN_ERROR);
+      }
+
+    /* Check file name */
+    if(check_filename(argv[optind+1],lax)==0)
+      {
+        fprintf(stderr,"Illegal LIF file name\n");
+        return(RETURN_ERROR);
+      }
+    first=0;
+    if(! info_flag)
+      {
+        if(sscanf(argv[optind+2],"%d",&first)!=1 || first < 0)
+          {
+            fprintf(stderr,"Illegal record number\n");
+            return(RETURN_ERROR);
+          }
+      }
+
+    /* Open LIF device */
+    if((lif_device=lif_open(argv[optind],(write_flag ? O_RDWR : O_RDONLY) | O_BINARY,0,physical_flag))==-1)
+      {
+        fprintf(stderr,"Error opening %s\n",argv[optind]);
+        return(RETURN_ERROR);
+      }
+
+    /* Find the file */
+    pad_name(argv[optind+1],cmp_name);
+    ret=lif_find_entry(lif_device,cmp_name,entry);
+    if(ret== -2)
+      {
+        fprintf(stderr,"This is not a LIF disk!\n");
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+    if(ret== -1)
+      {
+        fprintf(stderr,"File %s not found\n",argv[optind+1]);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+    if(lif_record_layout(entry,&record_length,&num_records))
+      {
+        fprintf(stderr,"File %s is not a DAT71 or SDATA file\n",argv[optind+1]);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+
+    /* the HP-71 does not allow to modify a secured file */
+    if(write_flag && ! force_flag && lif_record_secured(entry))
+      {
+        fprintf(stderr,"File %s is secured, use -f to overwrite its records\n",argv[optind+1]);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+
+    if(info_flag)
+      {
+        printf("%d records, record length %d\n",num_records,record_length);
+        lif_close(lif_device);
+        return(RETURN_OK);
+      }
+
+    if(first+count > num_records)
+      {
+        fprintf(stderr,"Record out of range, file has %d records\n",num_records);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+
+    length=count*record_length;
+    data=malloc(length);
+    if(data == (unsigned char *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+
+    if(write_flag)
+      {
+        SETMODE_STDIN_BINARY;
+        if(fread(data,sizeof(unsigned char),length,stdin)!=(size_t) length)
+          {
+            fprintf(stderr,"Not enough input data for %d records\n",count);
+            free(data);
+            lif_close(lif_device);
+            return(RETURN_ERROR);
+          }
+        ret=lif_write_records(lif_device,entry,first,count,data);
+      }
+    else
+      {
+        ret=lif_read_records(lif_device,entry,first,count,data);
+        if(ret==0)
+          {
+            SETMODE_STDOUT_BINARY;
+            fwrite(data,sizeof(unsigned char),length,stdout);
+          }
+      }
+    if(ret)
+      {
+        fprintf(stderr,"Records exceed the space allocated to the file\n");
+      }
+
+    free(data);
+    lif_close(lif_device);
+    return(ret ? RETURN_ERROR : RETURN_OK);
+  }
@@ -0,0 +1,218 @@
+/* lifresize.c -- grow or shrink the directory of a LIF image file in place */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* The directory is followed by the data area. If the directory grows
+   only the files that start inside the new directory area are moved.
+   LIF media expect the files in directory order, the free space starts
+   behind the last directory entry. Thus a moved file is copied behind
+   the last file and its entry is moved to the end of the directory. All
+   other files stay where they are. If the directory shrinks, the freed
+   blocks become free space in front of the first file. Block 0 is
+   written last, so the old directory stays valid until all data has
+   been moved. */
+
+#include<stdio.h>
+#include<fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "lifutils.h"
+#include"lif_block.h"
+#include "lif_create_entry.h"
+#include"lif_dir_utils.h"
+#include "lif_const.h"
+
+#define DEBUG 0
+
+void lifresize_usage(void)
+  {
+    fprintf(stderr,"Usage : lifutils lifresize [-p] LIFIMAGEFILE DIRECTORYSIZE\n");
+    fprintf(stderr,"        Grow or shrink the directory of a LIF image file in place.\n");
+    fprintf(stderr,"        DIRECTORYSIZE is the new number of directory entries.\n");
+    fprintf(stderr,"        Files in the way of a larger directory are moved behind the last file.\n");
+    fprintf(stderr,"        -p Resize the directory of a floppy disk with a LIF file system.\n");
+    fprintf(stderr,"           Note: this option is only supported on LINUX.\n");
+    fprintf(stderr,"           Specify the floppy device instead of the lif-image-filename.\n");
+    fprintf(stderr,"           See the LIFUTILS tutorial for details.\n");
+    fprintf(stderr,"\n");
+  }
+
+int lifresize(int argc, char **argv)
+  {
+    /* System variables */
+    int option; /* Command line option character */
+    int physical_flag; /* Option to use a physical device */
+    int lif_device; /* Descriptor of LIF device */
+    int i, j;
+
+    /* LIF disk values */
+    int dir_start; /* first block of the directory */
+    int dir_length; /* length of directory in blocks */
+    int new_length; /* new length of directory in blocks */
+    int dirsize; /* new number of directory entries */
+    int tracks, surfaces, blocks; /* medium geometry */
+    int medium_size; /* number of blocks of medium */
+    unsigned char header[SECTOR_SIZE]; /* block 0 */
+    unsigned char block[BLOCK_SIZE]; /* copy buffer */
+    unsigned char *old_dir; /* old directory */
+    unsigned char *new_dir; /* new directory */
+
+    /* Directory values */
+    int num_slots; /* directory entries up to the end of directory mark */
+    int num_files; /* number of active files */
+    int file_type; /* file type word */
+    int new_entry; /* entry number in new directory */
+    int start_block; /* first block of file */
+    int num_blocks; /* number of blocks in file */
+    int new_start; /* first block of moved file */
+    int moved_files; /* number of moved files */
+    int keep_deleted; /* keep the deleted entries in the new directory */
+
+    /* Process command line options */
+    optind=1;
+    physical_flag=0;
+    while ((option=getopt(argc,argv,"p?"))!=-1)
+      {
+        switch(option)
+          {
+            case 'p' : physical_flag=1;
+                       break;
+            case '?' : lifresize_usage();
+                       return(RETURN_OK);
+          }
+      }
+
+    /* Are the right number of names specified ? */
+    if( optind != argc-2  )
+      {
+        lifresize_usage();
+        return(RETURN_ERROR);
+      }
+    if (sscanf(argv[optind+1],"%d",&dirsize)!= 1 || dirsize < 1)
+      {
+        lifresize_usage();
+        return(RETURN_ERROR);
+      }
+    new_length= (dirsize*ENTRY_SIZE)/SECTOR_SIZE + (int) (((dirsize*ENTRY_SIZE) % SECTOR_SIZE) !=0);
+
+    /* Open lif device */
+    if((lif_device=lif_open(argv[optind],O_RDWR | O_BINARY,0,physical_flag))==-1)
+      {
+        fprintf(stderr,"Error opening %s\n",argv[optind]);
+        return(RETURN_ERROR);
+      }
+
+    /* Now read block 0 to find where the directory is */
+    lif_read_block(lif_device,0,header);
+    if(get_lif_int(header+0,2)!=0x8000)
+      {
+        fprintf(stderr,"This is not a LIF disk!\n");
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+    dir_start=get_lif_int(header+8,4);
+    dir_length=get_lif_int(header+16,4);
+
+    /* get medium information */
+    tracks=get_lif_int(header+24,4);
+    surfaces=get_lif_int(header+28,4);
+    blocks=get_lif_int(header+32,4);
+    medium_size= tracks*surfaces*blocks;
+    if((tracks == surfaces) && (surfaces == blocks)) {
+       fprintf(stderr,"Medium was not initialized properly\n");
+       lif_close(lif_device);
+       return(RETURN_ERROR);
+    }
+    if (new_length > medium_size / 3) {
+       fprintf(stderr,"directory size too large\n");
+       lif_close(lif_device);
+       return(RETURN_ERROR);
+    }
+    debug_print("dir_start %d dir_length %d new_length %d\n",dir_start,dir_length,new_length);
+
+    /* read the old directory */
+    old_dir= malloc(dir_length*SECTOR_SIZE);
+    new_dir= malloc(new_length*SECTOR_SIZE);
+    if(old_dir == NULL || new_dir == NULL) {
+       fprintf(stderr,"Cannot allocate memory\n");
+       exit(1);
+    }
+    for(i=0;i<dir_length;i++) lif_read_block(lif_device,dir_start+i,old_dir+i*SECTOR_SIZE);
+
+    /* count the files and the files to move, find the end of the data */
+    num_slots=0;
+    num_files=0;
+    moved_files=0;
+    new_start=dir_start+new_length;
+    for(i=0;i<8*dir_length;i++) {
+       file_type=get_lif_int(old_dir+(i<<5)+10,2);
+       if(file_type==0xFFFF) break;
+       num_slots++;
+       if(file_type==0) continue; /* Skip deleted files */
+       start_block=get_lif_int(old_dir+(i<<5)+12,4);
+       num_blocks=get_lif_int(old_dir+(i<<5)+16,4);
+       if(start_block+num_blocks > new_start) new_start=start_block+num_blocks;
+       if(start_block < dir_start+new_length) moved_files++;
+       num_files++;
+    }
+    if(num_files > 8*new_length) {
+       fprintf(stderr,"Directory too small for %d files\n",num_files);
+       free(old_dir); free(new_dir);
+       lif_close(lif_device);
+       return(RETURN_ERROR);
+    }
+
+    /* build the new directory without the files to move. Keep the entry
+       numbers if possible, otherwise squeeze out deleted entries */
+    memset(new_dir,0xFF,new_length*SECTOR_SIZE);
+    keep_deleted= num_slots <= 8*new_length;
+    new_entry=0;
+    for(i=0;i<num_slots;i++) {
+       file_type=get_lif_int(old_dir+(i<<5)+10,2);
+       if(file_type==0 && ! keep_deleted) continue;
+       start_block=get_lif_int(old_dir+(i<<5)+12,4);
+       if(file_type!=0 && start_block < dir_start+new_length) continue;
+       memcpy(new_dir+(new_entry<<5),old_dir+(i<<5),ENTRY_SIZE);
+       new_entry++;
+    }
+
+    /* move the files that start inside the new directory area behind the
+       last file and append their entries in directory order */
+    for(i=0;i<num_slots;i++) {
+       file_type=get_lif_int(old_dir+(i<<5)+10,2);
+       if(file_type==0) continue;
+       start_block=get_lif_int(old_dir+(i<<5)+12,4);
+       num_blocks=get_lif_int(old_dir+(i<<5)+16,4);
+       if(start_block >= dir_start+new_length) continue;
+
+       /* the old extent stays valid until block 0 is written */
+       if(new_start+num_blocks > medium_size || new_entry == 8*new_length) {
+          fprintf(stderr,"No room to move file %.10s\n",old_dir+(i<<5));
+          free(old_dir); free(new_dir);
+          lif_close(lif_device);
+          return(RETURN_ERROR);
+       }
+       debug_print("move file from %d to %d, %d blocks\n",start_block,new_start,num_blocks);
+       for(j=0;j<num_blocks;j++) {
+          lif_read_block(lif_device,start_block+j,block);
+          lif_write_block(lif_device,new_start+j,block);
+       }
+       memcpy(new_dir+(new_entry<<5),old_dir+(i<<5),ENTRY_SIZE);
+       put_lif_int(new_dir+(new_entry<<5)+12,4,new_start);
+       new_entry++;
+       new_start+=num_blocks;
+    }
+
+    /* write the new directory and then block 0 */
+    for(i=0;i<new_length;i++) lif_write_block(lif_device,dir_start+i,new_dir+i*SECTOR_SIZE);
+    put_lif_int(header+16,4,new_length);
+    lif_write_block(lif_device,0,header);
+
+    if(moved_files) {
+       fprintf(stderr,"%d file(s) moved\n",moved_files);
+    }
+    free(old_dir);
+    free(new_dir);
+    lif_close(lif_device);
+    return(RETURN_OK);
+  }
@@ -0,0 +1,150 @@
+/* liftrace.c -- project the access time of a block trace on a disk drive */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* A block trace is written by any utility if LIFUTILSTRACE is set or
+   lifutils is called with --trace FILE. Each line contains an access:
+
+   R|W first_block number_of_blocks seconds_since_start
+
+   The trace is replayed through the physical disk layer (lif_phy.c) on
+   the simulated HP 9114 or HP 9122 drive of lif_phy_sim.c. Thus the
+   projected time includes the track reads, the track cache and the
+   batching of the sectors of a track into one command. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "lifutils.h"
+#include "lif_phy.h"
+#include "lif_const.h"
+
+#define TRACE_LINE_LEN 128
+
+void liftrace_usage(void)
+  {
+    fprintf(stderr,"Usage : lifutils liftrace [-d DRIVE] [-v] TRACEFILE\n");
+    fprintf(stderr,"        Project the time to replay a block access trace on a disk drive.\n");
+    fprintf(stderr,"        A trace is written by the LIFUTILS programs, if they are called\n");
+    fprintf(stderr,"        with lifutils --trace TRACEFILE or LIFUTILSTRACE=TRACEFILE is set.\n");
+    fprintf(stderr,"        -d DRIVE drive model: 9114 (default) or 9122\n");
+    fprintf(stderr,"        -v output the projected time of each access\n");
+    fprintf(stderr,"\n");
+  }
+
+int liftrace(int argc, char **argv)
+  {
+    /* System variables */
+    int option; /* Command line option character */
+    int verbose; /* output every access */
+    FILE *trace_file;
+    char line[TRACE_LINE_LEN];
+    char op;
+    int device, block, count, line_number, accesses, buffer_blocks;
+    long blocks_read, blocks_written;
+    double timestamp, traced;
+    unsigned char *buffer; /* data of an access */
+    struct lif_sim_times *times;
+
+    /* Process command line options */
+    optind=1;
+    verbose=0;
+    lif_sim_select("9114");
+    while ((option=getopt(argc,argv,"d:v?"))!=-1)
+      {
+        switch(option)
+          {
+            case 'd' : if(lif_sim_select(optarg))
+                         {
+                           fprintf(stderr,"Unknown drive model %s\n",optarg);
+                           return(RETURN_ERROR);
+                         }
+                       break;
+            case 'v' : verbose=1;
+                       break;
+            case '?' : liftrace_usage();
+                       return(RETURN_OK);
+          }
+      }
+
+    /* Are the right number of names specified ? */
+    if( optind != argc-1  )
+      {
+        liftrace_usage();
+        return(RETURN_ERROR);
+      }
+
+    if((trace_file=fopen(argv[optind],"r")) == (FILE *) NULL)
+      {
+        fprintf(stderr,"Error opening %s\n",argv[optind]);
+        return(RETURN_ERROR);
+      }
+
+    /* replay the trace on a blank disk */
+    device=lif_open_phy_controller(&lif_sim_controller,(char *) NULL);
+    times=lif_sim_get_times();
+    buffer= (unsigned char *) NULL;
+    buffer_blocks=0;
+    blocks_read=blocks_written=0;
+    accesses=0;
+    line_number=0;
+    traced=0.0;
+
+    while(fgets(line,TRACE_LINE_LEN,trace_file) != (char *) NULL)
+      {
+        line_number++;
+        if(line[0] == '#' || line[0] == '\n') continue;
+        if(sscanf(line,"%c %d %d %lf",&op,&block,&count,&timestamp) != 4 ||
+           (op != 'R' && op != 'W') || block < 0 || count < 0)
+          {
+            fprintf(stderr,"Invalid trace entry in line %d\n",line_number);
+            fclose(trace_file);
+            lif_close_phy_device(device);
+            free(buffer);
+            return(RETURN_ERROR);
+          }
+        if(count > buffer_blocks)
+          {
+            buffer_blocks=count;
+            buffer=realloc(buffer,(size_t) buffer_blocks*SECTOR_SIZE);
+            if(buffer == (unsigned char *) NULL)
+              {
+                fprintf(stderr,"Cannot allocate memory\n");
+                exit(1);
+              }
+            memset(buffer,0,(size_t) buffer_blocks*SECTOR_SIZE);
+          }
+        if(op == 'R')
+          {
+            lif_read_phy_blocks(device,block,count,buffer);
+            blocks_read+=count;
+          }
+        else
+          {
+            lif_write_phy_blocks(device,block,count,buffer);
+            blocks_written+=count;
+          }
+        accesses++;
+        traced=timestamp;
+        if(verbose) printf("%c %6d %4d %12.3f ms\n",op,block,count,times->clock_ms);
+      }
+    fclose(trace_file);
+    lif_close_phy_device(device);
+    free(buffer);
+
+    printf("Drive model        : HP %s\n",times->drive);
+    printf("Accesses           : %d\n",accesses);
+    printf("Blocks read        : %ld\n",blocks_read);
+    printf("Blocks written     : %ld\n",blocks_written);
+    printf("Commands           : %ld (%ld sectors)\n",times->commands,times->sectors);
+    printf("Seeks              : %ld (%ld cylinders)\n",times->seeks,times->cylinders);
+    printf("Head switches      : %ld\n",times->head_switches);
+    printf("Command overhead   : %10.3f s\n",times->command_ms/1000.0);
+    printf("Seek time          : %10.3f s\n",times->seek_ms/1000.0);
+    printf("Head switch time   : %10.3f s\n",times->head_ms/1000.0);
+    printf("Rotational latency : %10.3f s\n",times->latency_ms/1000.0);
+    printf("Transfer time      : %10.3f s\n",times->transfer_ms/1000.0);
+    printf("Projected time     : %10.3f s\n",times->clock_ms/1000.0);
+    printf("Traced time        : %10.3f s\n",traced);
+    return(RETURN_OK);
+  }
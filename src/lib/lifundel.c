@@ -0,0 +1,809 @@
+/* lifundel.c -- list, restore and carve deleted files of a LIF image file */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* A purged file keeps its directory entry except for the file type word,
+   which is set to zero. The entry is recoverable as long as none of its
+   blocks was allocated to another file later. This is checked with an
+   allocation bitmap of all active files.
+
+   Blocks that are neither allocated nor covered by a deleted entry are
+   scanned for known file contents (carving):
+
+     TEXT   a chain of text records terminated by 0xFFFF
+     LEX71  a plausible lex table header with a readable first keyword
+     PGM41  HP-41 instructions up to an END instruction, see
+            lifundel_end41 for the required evidence
+
+   Carved files always start at a block boundary. Empty blocks (all
+   0x00 or all 0xFF) are skipped. */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "config.h"
+#include "lifutils.h"
+#include "lif_block.h"
+#include "lif_dir_utils.h"
+#include "lif_create_entry.h"
+#include "lif_filetype.h"
+#include "lif_const.h"
+#include "jump41.h"
+#ifdef HAVE_FORK
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#define DEBUG 0
+
+/* largest HP-41 program that is searched for an END */
+#define PGM41_MAX_BLOCKS 64
+
+struct lifundel_candidate
+  {
+    int entry;          /* directory entry number, -1 for a carved file */
+    int carve_no;       /* number of a carved file */
+    unsigned char dir_entry[ENTRY_SIZE]; /* directory entry if not carved */
+    int start;          /* first block */
+    int blocks;         /* number of blocks */
+    long length;        /* length in bytes, -1 if unknown */
+    int used_blocks;    /* blocks now allocated to active files */
+    int valid;          /* extent lies inside the data area */
+    char *type;         /* detected file type or NULL */
+  };
+
+struct lifundel_image
+  {
+    int dir_start;      /* first block of the directory */
+    int dir_length;     /* length of directory in blocks */
+    int data_start;     /* first block of the data area */
+    int limit;          /* number of readable blocks */
+    unsigned char *data; /* blocks data_start .. limit-1 */
+    unsigned char *bitmap; /* allocated blocks */
+    unsigned char *claimed; /* blocks of deleted entries and carved files */
+    struct lifundel_candidate *cand;
+    int num_cand;
+  };
+
+void lifundel_usage(void)
+  {
+    fprintf(stderr,"Usage : lifutils lifundel [-c] [-j jobs] [-p] LIFIMAGEFILE [LIFIMAGEFILE ...]\n");
+    fprintf(stderr,"        or\n");
+    fprintf(stderr,"        lifutils lifundel -r ID [-t FILETYPE] [-l] [-p] LIFIMAGEFILE\n");
+    fprintf(stderr,"        or\n");
+    fprintf(stderr,"        lifutils lifundel -x ID [-p] LIFIMAGEFILE [OUTPUTFILE]\n");
+    fprintf(stderr,"        List, restore or extract deleted files of LIF image files\n");
+    fprintf(stderr,"        -c Scan unused blocks for TEXT, LEX71 and PGM41 file contents\n");
+    fprintf(stderr,"        -j jobs number of images that are scanned in parallel\n");
+    fprintf(stderr,"        -r ID restore the deleted file with entry number ID in place\n");
+    fprintf(stderr,"        -t FILETYPE file type of the restored file, if it cannot be detected\n");
+    fprintf(stderr,"        -x ID extract the raw data of a deleted file (ID is an entry\n");
+    fprintf(stderr,"           number) or of a carved file (ID is c1, c2, ...)\n");
+    fprintf(stderr,"        -l Relax file name checking, allow underscores in file names\n");
+    fprintf(stderr,"        -p Access a floppy disk with a LIF file system.\n");
+    fprintf(stderr,"           Note: this option is only supported on LINUX.\n");
+    fprintf(stderr,"           Specify the floppy device instead of the lif-image-filename.\n");
+    fprintf(stderr,"           See the LIFUTILS tutorial for details.\n");
+    fprintf(stderr,"\n");
+  }
+
+/* allocation bitmap helpers */
+
+static void lifundel_mark(unsigned char *map, int start, int num, int limit)
+  {
+    int i;
+
+    for(i=start; i<start+num && i<limit; i++)
+      {
+        if(i >= 0) map[i>>3]|= 1 << (i & 7);
+      }
+  }
+
+static int lifundel_count(unsigned char *map, int start, int num)
+  {
+    int i, n;
+
+    n=0;
+    for(i=start; i<start+num; i++)
+      {
+        if(map[i>>3] & (1 << (i & 7))) n++;
+      }
+    return(n);
+  }
+
+/* file content signatures */
+
+static int lifundel_empty_block(unsigned char *data)
+  {
+    int i;
+
+    for(i=1; i<BLOCK_SIZE; i++)
+      {
+        if(data[i]!=data[0]) return(0);
+      }
+    return(data[0]==0x00 || data[0]==0xFF);
+  }
+
+static int lifundel_is_end41(unsigned char *p)
+  {
+    /* END: first byte C0..CD, third byte without the label flag. The
+       .END., packed and uncompiled (0x2F, see prog41bar.c) flags are
+       ignored */
+    return(p[0]>=0xC0 && p[0]<=0xCD && (p[2] & 0xD9)==0x09);
+  }
+
+/* link of a global label or END to the previous one in bytes */
+static long lifundel_link41(unsigned char *p)
+  {
+    return(((long)((p[0] & 1) << 8 | p[1]))*7 + ((p[0] >> 1) & 7));
+  }
+
+/* length of a text file in bytes or -1 */
+static long lifundel_text_length(unsigned char *data, long size)
+  {
+    long pos;
+    unsigned int len, i;
+    int records;
+
+    pos=0;
+    records=0;
+    while(pos+2 <= size)
+      {
+        len=(data[pos]<<8) | data[pos+1];
+        pos+=2;
+        if(len==0xFFFF) return(records ? pos : -1);
+        if(len==0xFFFE) continue;
+        if(pos+len > size) return(-1);
+        for(i=0; i<len; i++)
+          {
+            if(data[pos+i] < 0x20 && data[pos+i]!='\t') return(-1);
+            if(data[pos+i] == 0x7F || data[pos+i]==0xFF) return(-1);
+          }
+        pos+= len + (len & 1);
+        records++;
+      }
+    return(-1);
+  }
+
+/* nybble i of a lex file, low nybble first */
+static int lifundel_nib(unsigned char *data, long i)
+  {
+    return((data[i>>1] >> ((i & 1) << 2)) & 0xF);
+  }
+
+static int lifundel_nibs(unsigned char *data, long i, int n)
+  {
+    int v, k;
+
+    v=0;
+    for(k=0; k<n; k++) v|= lifundel_nib(data,i+k) << (k*4);
+    return(v);
+  }
+
+/* check for the header of the first lex table, see lexcat71.c */
+static int lifundel_is_lex71(unsigned char *data, long size)
+  {
+    long ptr, txt_start, key_start, nsize;
+    int lo_tok, hi_tok, len, i, c;
+
+    nsize=size*2;
+    if(nsize < 64) return(0);
+    lo_tok=lifundel_nibs(data,2,2);
+    hi_tok=lifundel_nibs(data,4,2);
+    if(lo_tok == 0 || lo_tok > hi_tok) return(0);
+    ptr=11;
+    if(lifundel_nib(data,ptr)==0xF) ptr++; else ptr+=80;
+    txt_start=lifundel_nibs(data,ptr,4)+ptr-1;
+
+    /* skip text table, message table and poll handler offsets */
+    ptr+=13;
+    if(txt_start <= ptr || txt_start >= nsize) return(0);
+
+    /* the keyword of the first main table entry must be readable */
+    key_start=lifundel_nibs(data,ptr,3)+txt_start;
+    if(key_start+1 >= nsize) return(0);
+    len=(lifundel_nib(data,key_start)+1)/2;
+    if(len < 1 || key_start+1+2*len > nsize) return(0);
+    for(i=0; i<len; i++)
+      {
+        c=lifundel_nibs(data,key_start+1+2*i,2);
+        if(c <= ' ' || c >= 0x7F) return(0);
+      }
+    return(1);
+  }
+
+/* offset of the END of an HP-41 program or -1. Two bytes match the
+   header of an END at about every thousandth position of random data,
+   thus the data must decode to instructions up to the END and
+   - every global label has an alpha label with at least one character
+   - the link of every global label and END after the first one is zero
+     (not yet packed) or reaches the previous global label
+   - the byte behind the END is the checksum of the program or the END
+     is linked to a global label of the program */
+static long lifundel_end41(unsigned char *data, long size)
+  {
+    long pc, prev, link;
+    int i, checksum;
+
+    pc=0;
+    prev= -1;
+    while(pc+3 <= size)
+      {
+        if(data[pc]>=0xC0 && data[pc]<=0xCD)
+          {
+            link=lifundel_link41(data+pc);
+            if(prev != -1 && link != 0 && pc-link != prev) return(-1);
+            if(! (data[pc+2] & 0x80))
+              {
+                if(! lifundel_is_end41(data+pc)) return(-1);
+                if(prev != -1 && link != 0) return(pc);
+                if(pc+4 > size) return(-1);
+                checksum=0;
+                for(i=0; i< pc+3; i++) checksum+= data[i];
+                return((checksum & 0xFF) == data[pc+3] ? pc : -1);
+              }
+            if((data[pc+2] & 0xF0) != 0xF0 || (data[pc+2] & 0xF) < 2) return(-1);
+            prev=pc;
+          }
+        pc+=jump41_length(data,(int) pc,(int) size);
+      }
+    return(-1);
+  }
+
+/* detect the type of a deleted file from its directory entry and data */
+static char *lifundel_detect(unsigned char *entry, unsigned char *data, long size)
+  {
+    long len;
+
+    /* PGM41: program bytes, END and a checksum byte */
+    len=get_lif_int(entry+28,2)+1;
+    if(len >= 4 && len <= size && lifundel_end41(data,len) == len-4) return("PGM41");
+    if(lifundel_text_length(data,size) > 0) return("TEXT");
+    if(lifundel_is_lex71(data,size)) return("LEX71");
+    return((char *) NULL);
+  }
+
+static struct lifundel_candidate *lifundel_add(struct lifundel_image *img)
+  {
+    struct lifundel_candidate *c;
+
+    img->cand= realloc(img->cand,(img->num_cand+1)*sizeof(struct lifundel_candidate));
+    if(img->cand == (struct lifundel_candidate *) NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    c= &img->cand[img->num_cand++];
+    memset(c,0,sizeof(struct lifundel_candidate));
+    c->entry= -1;
+    c->length= -1;
+    c->valid= 1;
+    return(c);
+  }
+
+/* carve the blocks that are neither allocated nor claimed */
+static void lifundel_carve(struct lifundel_image *img)
+  {
+    int b, run_end, n, carve_no;
+    long len;
+    unsigned char *p;
+    char *type;
+    struct lifundel_candidate *c;
+
+    carve_no=0;
+    b=img->data_start;
+    while(b < img->limit)
+      {
+        if(lifundel_count(img->bitmap,b,1) || lifundel_count(img->claimed,b,1))
+          {
+            b++;
+            continue;
+          }
+        p=img->data+(long)(b-img->data_start)*BLOCK_SIZE;
+        if(lifundel_empty_block(p))
+          {
+            b++;
+            continue;
+          }
+
+        /* end of the unused run */
+        run_end=b;
+        while(run_end < img->limit && ! lifundel_count(img->bitmap,run_end,1) &&
+              ! lifundel_count(img->claimed,run_end,1)) run_end++;
+
+        type=(char *) NULL;
+        n=0;
+        len= -1;
+        if((len=lifundel_text_length(p,(long)(run_end-b)*BLOCK_SIZE)) > 0)
+          {
+            type="TEXT";
+            n=(int) ((len+BLOCK_SIZE-1)/BLOCK_SIZE);
+          }
+        else if(lifundel_is_lex71(p,(long)(run_end-b)*BLOCK_SIZE))
+          {
+            /* the length is unknown, take all non empty blocks */
+            type="LEX71";
+            len= -1;
+            for(n=1; b+n < run_end; n++)
+              {
+                if(lifundel_empty_block(p+(long)n*BLOCK_SIZE)) break;
+              }
+          }
+        else
+          {
+            n= run_end-b;
+            if(n > PGM41_MAX_BLOCKS) n= PGM41_MAX_BLOCKS;
+            len=lifundel_end41(p,(long) n*BLOCK_SIZE);
+            if(len >= 0 && len+4 <= (long) n*BLOCK_SIZE)
+              {
+                /* END and checksum byte */
+                type="PGM41";
+                len+=4;
+                n=(int) ((len+BLOCK_SIZE-1)/BLOCK_SIZE);
+              }
+          }
+        if(type == (char *) NULL)
+          {
+            b++;
+            continue;
+          }
+        c=lifundel_add(img);
+        c->carve_no= ++carve_no;
+        c->start=b;
+        c->blocks=n;
+        c->length=len;
+        c->type=type;
+        debug_print("carved %s at %d, %d blocks\n",type,b,n);
+        b+=n;
+      }
+  }
+
+static void lifundel_free(struct lifundel_image *img)
+  {
+    free(img->data);
+    free(img->bitmap);
+    free(img->claimed);
+    free(img->cand);
+  }
+
+/* read the image and collect all deleted and carved files */
+static int lifundel_scan(int lif_device, struct lifundel_image *img, int carve)
+  {
+    unsigned char header[SECTOR_SIZE];
+    unsigned char *dir;
+    int i, tracks, surfaces, blocks, num_blocks, file_type, start, len;
+    struct lifundel_candidate *c;
+    const struct lif_filetype *t;
+
+    memset(img,0,sizeof(struct lifundel_image));
+    lif_read_block(lif_device,0,header);
+    if(get_lif_int(header+0,2)!=0x8000)
+      {
+        fprintf(stderr,"This is not a LIF disk!\n");
+        return(RETURN_ERROR);
+      }
+    img->dir_start=get_lif_int(header+8,4);
+    img->dir_length=get_lif_int(header+16,4);
+    img->data_start=img->dir_start+img->dir_length;
+
+    /* image files may end behind the last used block */
+    tracks=get_lif_int(header+24,4);
+    surfaces=get_lif_int(header+28,4);
+    blocks=get_lif_int(header+32,4);
+    img->limit=tracks*surfaces*blocks;
+    num_blocks=lif_num_blocks(lif_device);
+    if((tracks == surfaces) && (surfaces == blocks)) img->limit=num_blocks;
+    if(num_blocks >= 0 && num_blocks < img->limit) img->limit=num_blocks;
+    if(img->limit < img->data_start)
+      {
+        fprintf(stderr,"Directory exceeds the medium\n");
+        return(RETURN_ERROR);
+      }
+
+    img->bitmap=calloc(img->limit/8+1,1);
+    img->claimed=calloc(img->limit/8+1,1);
+    dir=malloc(img->dir_length*SECTOR_SIZE);
+    img->data=malloc((long)(img->limit-img->data_start)*BLOCK_SIZE+1);
+    if(img->bitmap==NULL || img->claimed==NULL || dir==NULL || img->data==NULL)
+      {
+        fprintf(stderr,"Cannot allocate memory\n");
+        exit(1);
+      }
+    for(i=0; i<img->dir_length; i++) lif_read_block(lif_device,img->dir_start+i,dir+i*SECTOR_SIZE);
+    for(i=img->data_start; i<img->limit; i++)
+      {
+        lif_read_block(lif_device,i,img->data+(long)(i-img->data_start)*BLOCK_SIZE);
+      }
+
+    /* allocation bitmap of the header, the directory and all active files */
+    lifundel_mark(img->bitmap,0,img->data_start,img->limit);
+    for(i=0; i<8*img->dir_length; i++)
+      {
+        file_type=get_lif_int(dir+(i<<5)+10,2);
+        if(file_type==0xFFFF) break;
+        if(file_type==0) continue;
+        lifundel_mark(img->bitmap,get_lif_int(dir+(i<<5)+12,4),
+                      get_lif_int(dir+(i<<5)+16,4),img->limit);
+      }
+
+    /* deleted entries */
+    for(i=0; i<8*img->dir_length; i++)
+      {
+        file_type=get_lif_int(dir+(i<<5)+10,2);
+        if(file_type==0xFFFF) break;
+        if(file_type!=0) continue;
+        c=lifundel_add(img);
+        c->entry=i;
+        memcpy(c->dir_entry,dir+(i<<5),ENTRY_SIZE);
+        start=get_lif_int(dir+(i<<5)+12,4);
+        len=get_lif_int(dir+(i<<5)+16,4);
+        c->start=start;
+        c->blocks=len;
+        if(start < img->data_start || len < 1 || start+len > img->limit || start+len < start)
+          {
+            c->valid=0;
+            continue;
+          }
+        c->used_blocks=lifundel_count(img->bitmap,start,len);
+        lifundel_mark(img->claimed,start,len,img->limit);
+        c->type=lifundel_detect(c->dir_entry,img->data+(long)(start-img->data_start)*BLOCK_SIZE,
+                                (long) len*BLOCK_SIZE);
+        if(c->type != (char *) NULL)
+          {
+            t=lif_filetype_by_name(c->type);
+            c->length=lif_filetype_length(t->length_rule,c->dir_entry);
+            if(c->length > (long) len*BLOCK_SIZE) c->length= -1;
+          }
+      }
+    free(dir);
+
+    if(carve) lifundel_carve(img);
+    return(RETURN_OK);
+  }
+
+static struct lifundel_candidate *lifundel_find(struct lifundel_image *img, char *id)
+  {
+    int i, n;
+
+    if(id[0]=='c' || id[0]=='C')
+      {
+        if(sscanf(id+1,"%d",&n)!=1) return((struct lifundel_candidate *) NULL);
+        for(i=0; i<img->num_cand; i++)
+          {
+            if(img->cand[i].entry== -1 && img->cand[i].carve_no==n) return(&img->cand[i]);
+          }
+      }
+    else
+      {
+        if(sscanf(id,"%d",&n)!=1) return((struct lifundel_candidate *) NULL);
+        for(i=0; i<img->num_cand; i++)
+          {
+            if(img->cand[i].entry==n) return(&img->cand[i]);
+          }
+      }
+    return((struct lifundel_candidate *) NULL);
+  }
+
+/* list all candidates of one image to standard output */
+static int lifundel_report(char *image, int physical_flag, int carve, int show_name)
+  {
+    int lif_device, i;
+    struct lifundel_image img;
+    struct lifundel_candidate *c;
+    char id[12];
+    char *status;
+
+    if((lif_device=lif_open(image,O_RDONLY | O_BINARY,0,physical_flag))==-1)
+      {
+        fprintf(stderr,"Error opening %s\n",image);
+        return(RETURN_ERROR);
+      }
+    if(lifundel_scan(lif_device,&img,carve)!=RETURN_OK)
+      {
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+    lif_close(lif_device);
+
+    if(show_name) printf("Image: %s\n",image);
+    printf("ID    NAME         START BLOCKS STATUS      TYPE\n");
+    for(i=0; i<img.num_cand; i++)
+      {
+        c= &img.cand[i];
+        if(c->entry >= 0)
+          {
+            sprintf(id,"%d",c->entry);
+            if(! c->valid) status="invalid";
+            else if(c->used_blocks) status="overwritten";
+            else status="intact";
+            printf("%-5s %-10.10s %6d %6d %-11s %s\n",id,c->dir_entry,c->start,
+                   c->blocks,status,c->type ? c->type : "?");
+          }
+        else
+          {
+            sprintf(id,"c%d",c->carve_no);
+            printf("%-5s %-10s %6d %6d %-11s %s\n",id,"",c->start,c->blocks,
+                   "carved",c->type);
+          }
+      }
+    lifundel_free(&img);
+    return(RETURN_OK);
+  }
+
+/* scan several images, at most jobs at a time. The output of each image
+   is collected through a pipe and written in the order of the images */
+static int lifundel_report_all(char **images, int num_images, int jobs,
+                               int physical_flag, int carve)
+  {
+    int i, ret;
+#ifdef HAVE_FORK
+    int next, fd[2], status;
+    int *fds;
+    pid_t *pids;
+    char buffer[4096];
+    ssize_t n;
+
+    if(jobs > 1 && num_images > 1 && ! physical_flag)
+      {
+        fds=malloc(num_images*sizeof(int));
+        pids=malloc(num_images*sizeof(pid_t));
+        if(fds==NULL || pids==NULL)
+          {
+            fprintf(stderr,"Cannot allocate memory\n");
+            exit(1);
+          }
+        ret=RETURN_OK;
+        next=0;
+        fflush(stdout);
+        for(i=0; i<num_images; i++)
+          {
+            while(next < num_images && next < i+jobs)
+              {
+                if(pipe(fd))
+                  {
+                    fprintf(stderr,"Cannot create pipe\n");
+                    exit(1);
+                  }
+                pids[next]=fork();
+                if(pids[next] == (pid_t) -1)
+                  {
+                    fprintf(stderr,"Cannot create process\n");
+                    exit(1);
+                  }
+                if(pids[next]==0)
+                  {
+                    close(fd[0]);
+                    dup2(fd[1],1);
+                    close(fd[1]);
+                    status=lifundel_report(images[next],physical_flag,carve,1);
+                    fflush(stdout);
+                    _exit(status==RETURN_OK ? 0 : 1);
+                  }
+                close(fd[1]);
+                fds[next]=fd[0];
+                next++;
+              }
+            while((n=read(fds[i],buffer,sizeof(buffer))) > 0)
+              {
+                fwrite(buffer,1,n,stdout);
+              }
+            fflush(stdout);
+            close(fds[i]);
+            waitpid(pids[i],&status,0);
+            if(! WIFEXITED(status) || WEXITSTATUS(status)!=0) ret=RETURN_ERROR;
+          }
+        free(fds);
+        free(pids);
+        return(ret);
+      }
+#endif
+    ret=RETURN_OK;
+    for(i=0; i<num_images; i++)
+      {
+        if(lifundel_report(images[i],physical_flag,carve,num_images > 1)!=RETURN_OK) ret=RETURN_ERROR;
+      }
+    return(ret);
+  }
+
+int lifundel(int argc, char **argv)
+  {
+    /* System variables */
+    int option; /* Command line option character */
+    int physical_flag; /* Option to use a physical device */
+    int lax; /* Option to relax file name checking */
+    int carve; /* Option to scan unused blocks */
+    int jobs; /* number of parallel scans */
+    char *restore_id; /* ID of file to restore */
+    char *extract_id; /* ID of file to extract */
+    char *type_name; /* file type of restored file */
+    int lif_device; /* Descriptor of LIF device */
+    FILE *output_file; /* Output file stream */
+    struct lifundel_image img;
+    struct lifundel_candidate *c;
+    const struct lif_filetype *t;
+    unsigned char dir_data[SECTOR_SIZE];
+    char name[NAME_LEN+1];
+    char cmp_name[NAME_LEN];
+    long length;
+    int i, file_type;
+
+    physical_flag=0;
+    lax=0;
+    carve=0;
+    jobs=1;
+#if defined(HAVE_FORK) && defined(_SC_NPROCESSORS_ONLN)
+    jobs=(int) sysconf(_SC_NPROCESSORS_ONLN);
+    if(jobs < 1) jobs=1;
+#endif
+    restore_id=(char *) NULL;
+    extract_id=(char *) NULL;
+    type_name=(char *) NULL;
+
+    optind=1;
+    while ((option=getopt(argc,argv,"cj:r:t:x:plh?"))!=-1)
+      {
+        switch(option)
+          {
+            case 'c' : carve=1;
+                       break;
+            case 'j' : if(sscanf(optarg,"%d",&jobs)!=1 || jobs < 1)
+                         {
+                           lifundel_usage();
+                           return(RETURN_ERROR);
+                         }
+                       break;
+            case 'r' : restore_id=optarg;
+                       break;
+            case 't' : type_name=optarg;
+                       break;
+            case 'x' : extract_id=optarg;
+                       break;
+            case 'p' : physical_flag=1;
+                       break;
+            case 'l' : lax=1;
+                       break;
+            case 'h' :
+            case '?' : lifundel_usage();
+                       return(RETURN_OK);
+          }
+      }
+
+    /* list mode */
+    if(restore_id == (char *) NULL && extract_id == (char *) NULL)
+      {
+        if(optind >= argc)
+          {
+            lifundel_usage();
+            return(RETURN_ERROR);
+          }
+        return(lifundel_report_all(argv+optind,argc-optind,jobs,physical_flag,carve));
+      }
+
+    if(restore_id != (char *) NULL && extract_id != (char *) NULL)
+      {
+        lifundel_usage();
+        return(RETURN_ERROR);
+      }
+    if((restore_id != (char *) NULL && optind != argc-1) ||
+       (extract_id != (char *) NULL && optind != argc-1 && optind != argc-2))
+      {
+        lifundel_usage();
+        return(RETURN_ERROR);
+      }
+    t=(const struct lif_filetype *) NULL;
+    if(type_name != (char *) NULL)
+      {
+        if((t=lif_filetype_by_name(type_name)) == (const struct lif_filetype *) NULL)
+          {
+            fprintf(stderr,"Unknown file type %s\n",type_name);
+            return(RETURN_ERROR);
+          }
+      }
+
+    if((lif_device=lif_open(argv[optind],(restore_id ? O_RDWR : O_RDONLY) | O_BINARY,0,physical_flag))==-1)
+      {
+        fprintf(stderr,"Error opening %s\n",argv[optind]);
+        return(RETURN_ERROR);
+      }
+    if(lifundel_scan(lif_device,&img,carve || extract_id != (char *) NULL)!=RETURN_OK)
+      {
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+    c=lifundel_find(&img,restore_id ? restore_id : extract_id);
+    if(c == (struct lifundel_candidate *) NULL || ! c->valid)
+      {
+        fprintf(stderr,"No recoverable file %s\n",restore_id ? restore_id : extract_id);
+        lifundel_free(&img);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+
+    /* extract the raw file data */
+    if(extract_id != (char *) NULL)
+      {
+        if(optind==argc-2)
+          {
+            output_file=fopen(argv[argc-1],"wb");
+            if(output_file == (FILE *) NULL)
+              {
+                fprintf(stderr,"Error opening %s\n",argv[argc-1]);
+                lifundel_free(&img);
+                lif_close(lif_device);
+                return(RETURN_ERROR);
+              }
+          }
+        else
+          {
+            SETMODE_STDOUT_BINARY ;
+            output_file=stdout;
+          }
+        length= c->length >= 0 ? c->length : (long) c->blocks*BLOCK_SIZE;
+        fwrite(img.data+(long)(c->start-img.data_start)*BLOCK_SIZE,1,length,output_file);
+        if(output_file != stdout) fclose(output_file);
+        lifundel_free(&img);
+        lif_close(lif_device);
+        return(RETURN_OK);
+      }
+
+    /* restore a deleted entry in place */
+    if(c->entry < 0)
+      {
+        fprintf(stderr,"Carved files cannot be restored, extract them\n");
+        lifundel_free(&img);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+    if(c->used_blocks)
+      {
+        fprintf(stderr,"File was overwritten, %d of %d blocks are in use\n",c->used_blocks,c->blocks);
+        lifundel_free(&img);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+    if(t == (const struct lif_filetype *) NULL && c->type != (char *) NULL)
+      {
+        t=lif_filetype_by_name(c->type);
+      }
+    if(t == (const struct lif_filetype *) NULL)
+      {
+        fprintf(stderr,"File type cannot be detected, specify it with -t\n");
+        lifundel_free(&img);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+
+    /* the name must be legal and unique */
+    memcpy(name,c->dir_entry,NAME_LEN);
+    name[NAME_LEN]='\0';
+    for(i=NAME_LEN-1; i>=0 && name[i]==' '; i--) name[i]='\0';
+    if(check_filename(name,lax)==0)
+      {
+        fprintf(stderr,"Illegal LIF file name\n");
+        lifundel_free(&img);
+        lif_close(lif_device);
+        return(RETURN_ERROR);
+      }
+    pad_name(name,cmp_name);
+    for(i=0; i<8*img.dir_length; i++)
+      {
+        if((i & 7)==0) lif_read_block(lif_device,img.dir_start+(i>>3),dir_data);
+        file_type=get_lif_int(dir_data+((i & 7)<<5)+10,2);
+        if(file_type==0xFFFF) break;
+        if(file_type==0) continue;
+        if(compare_names((char *)dir_data+((i & 7)<<5),cmp_name))
+          {
+            fprintf(stderr,"File %s already exists\n",name);
+            lifundel_free(&img);
+            lif_close(lif_device);
+            return(RETURN_ERROR);
+          }
+      }
+
+    put_lif_int(c->dir_entry+10,2,t->code);
+    lif_write_dir_entry(lif_device,img.dir_start,c->entry,c->dir_entry);
+    lifundel_free(&img);
+    lif_close(lif_device);
+    return(RETURN_OK);
+  }
@@ -70,10 +70,15 @@ int lifput(int argc, char **argv);
 int lifrename(int argc, char **argv);
 int lifstat(int argc, char **argv);
 int lifheader(int argc, char **argv);
+int lifjournal(int argc, char **argv);
 int lifmod(int argc, char **argv);
 int lifraw(int argc, char **argv);
+int lifrec(int argc, char **argv);
+int lifresize(int argc, char **argv);
 int liftext(int argc, char **argv);
 int liftext75(int argc, char **argv);
+int liftrace(int argc, char **argv);
+int lifundel(int argc, char **argv);
 int outp41(int argc, char **argv);
 int out71(int argc, char **argv);
 int prog41bar(int argc, char **argv);
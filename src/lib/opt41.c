@@ -0,0 +1,164 @@
+/* opt41.c -- peephole size optimizer for HP41 programs */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* The optimizer replaces instructions of a program by shorter ones with
+   the same effect. The rules are:
+
+   - RCL 00-15 and STO 00-15 in the 2 byte form become the 1 byte form
+   - LBL 00-14 in the 2 byte form becomes the 1 byte form
+   - NULL bytes are removed, unless they separate two numbers or follow
+     a test. A test skips the NULL instead of the following instruction
+   - a text append that follows a text is merged into it, if the text
+     has at least one character and the merged text has at most 15
+     characters. A text that follows a test or an XROM function, which
+     may be a test, is not merged, because only the first text would
+     be skipped
+
+   The jump distances of the program have to be computed after the
+   optimization (see jump41.c). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lifutils.h"
+#include "jump41.h"
+#include "opt41.h"
+
+#define DEBUG 0
+
+static char *opt41_rule_names[OPT41_RULES]=
+  {
+    "short RCL and STO",
+    "short LBL",
+    "NULL",
+    "text append"
+  };
+
+static int opt41_is_digit(unsigned char byte)
+  {
+    return(byte >= 0x10 && byte <= 0x1c);
+  }
+
+static int opt41_is_text(unsigned char byte)
+  {
+    return(byte >= 0xf1);
+  }
+
+static int opt41_is_test(unsigned char byte)
+  {
+    /* return 1 if the instruction may skip the next instruction */
+    switch(byte)
+      {
+        case 0x44 : /* X<Y? */
+        case 0x45 : /* X>Y? */
+        case 0x46 : /* X<=Y? */
+        case 0x63 : /* X#0? */
+        case 0x64 : /* X>0? */
+        case 0x66 : /* X<0? */
+        case 0x67 : /* X=0? */
+        case 0x78 : /* X=Y? */
+        case 0x79 : /* X#Y? */
+        case 0x7b : /* X<=0? */
+        case 0x96 : /* ISG */
+        case 0x97 : /* DSE */
+        case 0xaa : /* FS?C */
+        case 0xab : /* FC?C */
+        case 0xac : /* FS? */
+        case 0xad : /* FC? */
+                    return(1);
+      }
+    /* XROM functions */
+    return(byte >= 0xa0 && byte <= 0xa7);
+  }
+
+int opt41_optimize(unsigned char *memory, int length, int *saved)
+  {
+    int pc;    /* address of the next instruction to read */
+    int out;   /* address of the next instruction to write */
+    int prev;  /* output address of the last instruction, -1 if none */
+    int prev2; /* output address of the instruction before, -1 if none */
+    int n, n1, n2, next;
+    unsigned char byte;
+
+    pc=0;
+    out=0;
+    prev= -1;
+    prev2= -1;
+    while(pc < length)
+      {
+        n=jump41_length(memory,pc,length);
+        if(pc+n > length) n=length-pc;
+        byte=memory[pc];
+
+        if(byte == 0x00)
+          {
+            next=pc+1;
+            while(next < length && memory[next] == 0x00) next++;
+            if(prev == -1 || ! ((opt41_is_digit(memory[prev]) && next < length &&
+               opt41_is_digit(memory[next])) || opt41_is_test(memory[prev])))
+              {
+                debug_print("drop NULL at %d\n",pc);
+                saved[OPT41_NULL]++;
+                pc++;
+                continue;
+              }
+          }
+        else if((byte == 0x90 || byte == 0x91) && n == 2 && memory[pc+1] <= 15)
+          {
+            debug_print("short RCL/STO at %d\n",pc);
+            memory[out]=(byte == 0x90 ? 0x20 : 0x30) + memory[pc+1];
+            saved[OPT41_SHORT_RCL_STO]++;
+            prev2=prev;
+            prev=out++;
+            pc+=2;
+            continue;
+          }
+        else if(byte == 0xcf && n == 2 && memory[pc+1] <= 14)
+          {
+            debug_print("short LBL at %d\n",pc);
+            memory[out]=0x01 + memory[pc+1];
+            saved[OPT41_SHORT_LBL]++;
+            prev2=prev;
+            prev=out++;
+            pc+=2;
+            continue;
+          }
+        else if(opt41_is_text(byte) && n == (byte&0xf)+1 && memory[pc+1] == 0x7f &&
+                prev != -1 && opt41_is_text(memory[prev]) &&
+                (prev2 == -1 || ! opt41_is_test(memory[prev2])))
+          {
+            n1=memory[prev]&0xf;
+            n2=byte&0xf;
+            if(n1+n2-1 <= 15)
+              {
+                debug_print("merge text append at %d\n",pc);
+                memmove(memory+out,memory+pc+2,n2-1);
+                memory[prev]=0xf0+n1+n2-1;
+                out+=n2-1;
+                saved[OPT41_TEXT_APPEND]+=2;
+                pc+=n;
+                continue;
+              }
+          }
+
+        memmove(memory+out,memory+pc,n);
+        prev2=prev;
+        prev=out;
+        out+=n;
+        pc+=n;
+      }
+    return(out);
+  }
+
+void opt41_report(FILE *fp, int *saved)
+  {
+    int i, total;
+
+    total=0;
+    for(i=0; i< OPT41_RULES; i++) total+=saved[i];
+    fprintf(fp,"Optimization saved %d bytes\n",total);
+    for(i=0; i< OPT41_RULES; i++)
+      {
+        fprintf(fp,"  %-18s : %d\n",opt41_rule_names[i],saved[i]);
+      }
+  }
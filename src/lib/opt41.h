@@ -0,0 +1,19 @@
+/* opt41.h -- peephole size optimizer for HP41 programs */
+/* 2026 J. Siebold, and placed under the GPL */
+
+#include <stdio.h>
+
+/* optimizer rules */
+#define OPT41_SHORT_RCL_STO 0
+#define OPT41_SHORT_LBL 1
+#define OPT41_NULL 2
+#define OPT41_TEXT_APPEND 3
+#define OPT41_RULES 4
+
+int opt41_optimize(unsigned char *memory, int length, int *saved);
+/* Optimize the program memory with length bytes in place and return the
+   new length. saved[rule] is incremented by the number of bytes that
+   were saved by each rule */
+
+void opt41_report(FILE *fp, int *saved);
+/* Output the number of bytes saved by each rule */
@@ -13,15 +13,19 @@
 #include "lif_create_entry.h"
 #include "lif_dir_utils.h"
 #include "lif_const.h"
+#include "jump41.h"
+#include "opt41.h"
 
 #define DEBUG 0
 
 void raw41lif_usage(void)
 {
-   fprintf(stderr,"Usage : lifutils raw41lif LIFFILENAME INPUTFILE > output file \n");
+   fprintf(stderr,"Usage : lifutils raw41lif [-O] LIFFILENAME INPUTFILE > output file \n");
    fprintf(stderr,"        or\n");
-   fprintf(stderr,"        lifutils raw41lif LIFFILENAME < input file > output file \n");
+   fprintf(stderr,"        lifutils raw41lif [-O] LIFFILENAME < input file > output file \n");
    fprintf(stderr,"        Convert a HP41C program raw file to a LIF file\n");
+   fprintf(stderr,"        -O optimize the size of the program and output the bytes saved\n");
+   fprintf(stderr,"           by each rule on standard error\n");
    fprintf(stderr,"        -r skip an existing LIF header of the input file\n");
    fprintf(stderr,"\n");
 }
@@ -211,20 +215,27 @@ int raw41lif(int argc, char**argv)
     int checksum;    /* checksum */
     unsigned char memory[MEMORY_SIZE]; /* HP41 program memory */
     FILE *fp;
+    int optimize;
+    int saved[OPT41_RULES];
 
     int i,j,option;
 
+    optimize=0;
+    for(i=0; i< OPT41_RULES; i++) saved[i]=0;
+
     /* command line options */
-    while ((option=getopt(argc,argv,"?"))!=-1)
+    while ((option=getopt(argc,argv,"O?"))!=-1)
       {
         switch(option)
           {
+            case 'O' : optimize=1;
+                       break;
             case '?' : raw41lif_usage();
                        return(RETURN_OK);
           }
       }
 
-    if(argc!=2 && argc!=3)
+    if(optind!=argc-1 && optind!=argc-2)
        {
          raw41lif_usage();
          return(RETURN_ERROR);
@@ -238,7 +249,7 @@ int raw41lif(int argc, char**argv)
       }
 
     /* Pad the filename with spaces */
-    pad_name(argv[1],lif_filename);
+    pad_name(argv[optind],lif_filename);
     debug_print("LIF filename: %s\n", lif_filename);
     optind++;
 
@@ -261,6 +272,14 @@ int raw41lif(int argc, char**argv)
     file_length=read_prog(fp,memory); /* Read in the program file */
     raw41lif_decode_prog(memory,file_length,&prog_length);
     debug_print("prog_length %d\n", prog_length);
+    if(optimize)
+      {
+        prog_length=opt41_optimize(memory,prog_length,saved);
+        opt41_report(stderr,saved);
+      }
+    /* enter the distances of the local jumps, keep the distances compiled
+       by the calculator unless the program was optimized */
+    jump41_compile(memory,prog_length,optimize);
 
     /* create and write directory entry */
     create_entry(dir_entry,lif_filename,0xE080,0,prog_length+1,0);
@@ -25,6 +25,16 @@ static struct {
 
 static int num_xrom_ids; /* Number of entries */
 
+/* Index of the xrom_ids table: the table index for each ROM and function id
+   and a hash table of the case folded function and alternate function names.
+   The first entry of a name or id wins, as with the former sequential
+   search */
+
+#define XROM_HASH_SIZE 8192   /* power of two, more than twice the names */
+
+static short xrom_by_id[32][64];
+static short xrom_by_name[XROM_HASH_SIZE];
+
 #define MAX_XROMNAME 21
 
 /* check, whether HP 41 text bytes contain characters that can be converted to UTF */
@@ -107,37 +117,86 @@ int utfstrcasecmp(char * str1, char * str2) {
 void init_xrom(void)
    {
       num_xrom_ids=0;
+      memset(xrom_by_id,0xff,sizeof(xrom_by_id));
+      memset(xrom_by_name,0xff,sizeof(xrom_by_name));
+   }
+
+/* hash a name case folded the same way as utfstrcasecmp does */
+
+static unsigned int xrom_hash(char *str)
+   {
+      unsigned int h= 2166136261u;
+      unsigned char c;
+
+      while((c= (unsigned char) *str++) != '\0') {
+         if(c < 0x80) c= tolower(c);
+         h= (h ^ c) * 16777619u;
+      }
+      return(h & (XROM_HASH_SIZE-1));
+   }
+
+/* get the hash table slot of a name: the slot with the name or the empty
+   slot where it belongs */
+
+static int xrom_slot(char *alpha)
+   {
+      int h, i;
+
+      h= xrom_hash(alpha);
+      while((i= xrom_by_name[h]) != -1) {
+         if(utfstrcasecmp(alpha,xrom_ids[i].name) == 0 ||
+            utfstrcasecmp(alpha,xrom_ids[i].alt_name) == 0) break;
+         h= (h+1) & (XROM_HASH_SIZE-1);
+      }
+      return(h);
+   }
+
+/* add the entry i of the xrom_ids table to the index, return 0 if it
+   was added, 1 for a duplicate entry and -1 for a conflicting id */
+
+static int index_xrom(int i)
+   {
+      int mm, ff, h, k;
+
+      mm= xrom_ids[i].rom;
+      ff= xrom_ids[i].fn;
+      k= xrom_by_id[mm][ff];
+      if(k != -1) {
+         if(utfstrcasecmp(xrom_ids[i].name,xrom_ids[k].name) == 0) return(1);
+         /* the name of a conflicting entry remains available to compile */
+         h= xrom_slot(xrom_ids[i].name);
+         if(xrom_by_name[h] == -1) xrom_by_name[h]= i;
+         return(-1);
+      }
+      xrom_by_id[mm][ff]= i;
+      h= xrom_slot(xrom_ids[i].name);
+      if(xrom_by_name[h] == -1) xrom_by_name[h]= i;
+      if(strlen(xrom_ids[i].alt_name) > 0) {
+         h= xrom_slot(xrom_ids[i].alt_name);
+         if(xrom_by_name[h] == -1) xrom_by_name[h]= i;
+      }
+      return(0);
    }
 
 /* Look up function name, return packed rom- and function id or -1 */
 int get_xrom_by_name(char * alpha)
    {
-      int j,mm,ff,i;
+      int i,mm,ff;
 
       debug_print("xrom lookup %s\n",alpha);
-      j = num_xrom_ids;
-      for( i = 0; i < j; ++ i ) {
-          if((utfstrcasecmp( alpha,xrom_ids[ i ].name )== 0) || (utfstrcasecmp( alpha,xrom_ids[ i ].alt_name ) == 0)) {
-              mm = xrom_ids[i].rom;
-              ff = xrom_ids[i].fn;
-              debug_print("xrom %s -> %d %d \n",alpha,mm,ff);
-              return((mm<<8)| ff  );
-          }
-      }
-      return(-1);
+      i= xrom_by_name[xrom_slot(alpha)];
+      if(i == -1) return(-1);
+      mm = xrom_ids[i].rom;
+      ff = xrom_ids[i].fn;
+      debug_print("xrom %s -> %d %d \n",alpha,mm,ff);
+      return((mm<<8)| ff  );
    }
 
 /* Look up rom- and function id, return index in xrom_ids table or -1 */
 int find_xrom_by_id(int mm, int ff)
    {
-      int j,i;
-
-      j= num_xrom_ids;
-      for( i = 0; i < j; ++ i ) {
-          if(xrom_ids[i].rom== mm && xrom_ids[i].fn == ff) 
-             return(i);
-      }
-      return(-1);
+      if(mm < 0 || mm > 31 || ff < 0 || ff > 63) return(-1);
+      return(xrom_by_id[mm][ff]);
    }
 
 /* get xrom function name by table index */
@@ -157,54 +216,135 @@ char * get_xrom_alt_name_by_index(int i)
        }
    }
 
+/* continue the 64 bit FNV-1a hash with the loaded xrom functions, thus the
+   hash identifies the loaded tables */
+unsigned long long hash_xrom(unsigned long long hash)
+   {
+      int i, j;
+      unsigned char *p;
+
+      for(i=0; i< num_xrom_ids; i++) {
+         hash= (hash ^ (unsigned char) xrom_ids[i].rom) * 1099511628211ULL;
+         hash= (hash ^ (unsigned char) xrom_ids[i].fn) * 1099511628211ULL;
+         for(j=0; j< 2; j++) {
+            p= (unsigned char *) (j == 0 ? xrom_ids[i].name : xrom_ids[i].alt_name);
+            do {
+               hash= (hash ^ *p) * 1099511628211ULL;
+            } while(*p++ != '\0');
+         }
+      }
+      return(hash);
+   }
+
+/* add a function to the xrom_ids table, return 0 if it was added, 1 for a
+   duplicate that was not added and -1 if the table is full or the id is
+   invalid */
+
+static int add_xrom(char *source, int rom, int fn, char *name, char *alt_name)
+  {
+    int ind, k;
+
+    if(rom < 0 || rom > 31 || fn < 0 || fn > 63 || num_xrom_ids == 32*64) {
+       fprintf(stderr,"Invalid or too many XROM entries in %s\n",source);
+       return(-1);
+    }
+    xrom_ids[num_xrom_ids].name=name;
+    xrom_ids[num_xrom_ids].alt_name=alt_name;
+    xrom_ids[num_xrom_ids].rom= rom;
+    xrom_ids[num_xrom_ids].fn= fn;
+    debug_print("%d %d %d %s %s\n",num_xrom_ids,xrom_ids[num_xrom_ids].rom, xrom_ids[num_xrom_ids].fn,
+          xrom_ids[num_xrom_ids].name,xrom_ids[num_xrom_ids].alt_name);
+    ind=index_xrom(num_xrom_ids);
+    /* same function loaded twice */
+    if(ind == 1) return(1);
+    if(ind == -1) {
+       k= find_xrom_by_id(rom,fn);
+       fprintf(stderr,"Warning: XROM %d,%d %s in %s conflicts with %s\n",rom,fn,
+          name,source,xrom_ids[k].name);
+    }
+    num_xrom_ids++;
+    return(0);
+  }
+
+/* load a built-in XROM table, return 0 if there is no table name */
+
+static int load_builtin_xrom(char *name)
+  {
+    const struct xrom_table *t;
+    const struct xrom_entry *e;
+    size_t len;
+
+    for(t= xrom_tables; t->name != NULL; t++) {
+       len=strlen(t->name);
+       if(strncmp(name,t->name,len) == 0 && (name[len] == '\0' || strcmp(name+len,".xrom") == 0)) break;
+    }
+    if(t->name == NULL) return(0);
+
+    for(e= t->entries; e->name != NULL; e++) {
+       if(add_xrom(name,e->rom,e->fn,(char *) e->name,(char *) e->alt_name) == -1) break;
+    }
+    return(1);
+  }
+
+/* open the file name.xrom in the directory dir */
+
+#ifdef _WIN32
+#define XROM_DIR_SEPARATOR '\\'
+#define XROM_DEFAULT_DIR ""
+#else
+#define XROM_DIR_SEPARATOR '/'
+#ifdef __APPLE__
+#define XROM_DEFAULT_DIR "/usr/local/share/lifutils/xroms/"
+#else
+#define XROM_DEFAULT_DIR "/usr/share/lifutils/xroms/"
+#endif
+#endif
+
+static FILE *open_xrom_file(char *dir, char *name)
+  {
+    char filename [256];
+    size_t len;
+
+    len=strlen(dir);
+    if(len+strlen(name)+7 > sizeof(filename)) return((FILE *) NULL);
+    strcpy(filename,dir);
+    if(len > 0 && dir[len-1] != XROM_DIR_SEPARATOR) {
+       filename[len++]= XROM_DIR_SEPARATOR;
+       filename[len]='\0';
+    }
+    strcat(filename,name);
+    strcat(filename,".xrom");
+    return(fopen(filename,"r"));
+  }
+
 void read_xrom(char *name)
   {
     /* Read in an XROM names file. This consists of lines, each consisting
        of 2 decimal numbers (ROM# and function#) and a name string, separated
-       by whitespace. The name must not contain any whitespace */
+       by whitespace. The name must not contain any whitespace.
 
-    /* TODO there should be an error handling for malloc or file open failures */
+       A file in the directory LIFUTILSXROMDIR takes precedence over the
+       built-in table of the same name. Without a built-in table the file
+       is searched in the default location or as a path name */
 
     FILE *xrom_file; /* XROM file name */
     char line[100]; /* Line from that file */
     int rom, fn; /* ROM and function numbers */
     char this_name[40]; /* name from this line */
     char alt_name[40]; /* name from this line */
-    char filename [256];
     char *buf, *alt_buf;
     int len;
-
-    /* open the file */
     char *path;
+
+    xrom_file= (FILE *) NULL;
     path=getenv("LIFUTILSXROMDIR");
-#ifdef _WIN32
-    if(path != (char *) NULL) {
-       strcpy(filename,path);
-       if(path[strlen(path)-1] != '\\') strcat(filename,"\\");
-    } else {
-      strcpy(filename,"");
-    }
-#endif
-#ifdef __linux__
     if(path != (char *) NULL) {
-       strcpy(filename,path);
-       if(path[strlen(path)-1] != '/') strcat(filename,"/");
-    } else {
-       strcpy(filename,"/usr/share/lifutils/xroms/");
+       xrom_file=open_xrom_file(path,name);
     }
-#endif
-#ifdef __APPLE__
-    if(path != (char *) NULL) {
-       strcpy(filename,path);
-       if(path[strlen(path)-1] != '/') strcat(filename,"/");
-    } else {
-       strcpy(filename,"/usr/local/share/lifutils/xroms/");
+    if(xrom_file == (FILE*) NULL)  {
+       if(load_builtin_xrom(name)) return;
+       if(path == (char *) NULL) xrom_file=open_xrom_file(XROM_DEFAULT_DIR,name);
     }
-#endif
-
-    strcat(filename,name);
-    strcat(filename,".xrom");
-    xrom_file=fopen(filename,"r");
     if(xrom_file == (FILE*) NULL)  {
         xrom_file=fopen(name,"r");
     }
@@ -212,29 +352,23 @@ void read_xrom(char *name)
 
     while(fgets(line,80,xrom_file))
       {
-        len=sscanf(line,"%d %d %s %s",&rom,&fn,this_name, alt_name);
+        len=sscanf(line,"%d %d %39s %39s",&rom,&fn,this_name, alt_name);
         if(len==3 || len == 4) 
           {
-	    buf=malloc ((strlen(this_name)+1)*sizeof(char));
-            if (buf == NULL) return;
+            if(len == 3) alt_name[0]='\0';
+            buf=malloc(strlen(this_name)+strlen(alt_name)+2);
+            if (buf == NULL) break;
             strcpy(buf,this_name);
-            xrom_ids[num_xrom_ids].name=buf;
-            xrom_ids[num_xrom_ids].rom= rom;
-            xrom_ids[num_xrom_ids].fn= fn;
-            if(len==4) {
-               alt_buf= malloc ((strlen(alt_name)+1)*sizeof(char));
-               strcpy(alt_buf,alt_name);
-            } else {
-               alt_buf= malloc (sizeof(char));
-               strcpy(alt_buf,"");
+            alt_buf=buf+strlen(this_name)+1;
+            strcpy(alt_buf,alt_name);
+            len=add_xrom(name,rom,fn,buf,alt_buf);
+            if(len == 1) free(buf);
+            if(len == -1) {
+               free(buf);
+               break;
             }
-            xrom_ids[num_xrom_ids].alt_name=alt_buf;
-            debug_print("%d %d %d %s %s\n",num_xrom_ids,xrom_ids[num_xrom_ids].rom, xrom_ids[num_xrom_ids].fn,
-                  xrom_ids[num_xrom_ids].name,xrom_ids[num_xrom_ids].alt_name);
-            num_xrom_ids++;
           }
       }
     /* close the file */
     fclose(xrom_file);
   }
-
@@ -3,11 +3,30 @@
 
 #define MAX_ALPHA 15
 
+/* XROM tables built into the program, generated from the files in the
+   xroms directory by xrom2c. Each table ends with a NULL name, the list of
+   tables ends with a NULL table name */
+
+struct xrom_entry {
+          int rom;              /* ROM ID */
+          int fn;               /* Function ID */
+          const char *name;     /* function name */
+          const char *alt_name; /* alternate function name or "" */
+   };
+
+struct xrom_table {
+          const char *name;     /* name of the XROM file without .xrom */
+          const struct xrom_entry *entries;
+   };
+
+extern const struct xrom_table xrom_tables[];
+
 void init_xrom(void);
 int get_xrom_by_name(char * alpha);
 int find_xrom_by_id(int mm, int ff);
 char * get_xrom_name_by_index(int ind);
 char * get_xrom_alt_name_by_index(int ind);
 void read_xrom(char *name);
+unsigned long long hash_xrom(unsigned long long hash);
 char *to_hp41_string(unsigned char * str, int len, int utf);
 int has_special_characters(unsigned char * str, int len);
@@ -24,9 +24,9 @@ void usage(void)
 int main(int argc, char **argv)
   {
     int output_device;
-    int cylinder, head, sector;
+    int cylinder, head;
     FILE *input_file;
-    unsigned char data[SECTOR_SIZE];
+    unsigned char data[PHY_SECTORS*SECTOR_SIZE];
 
     if((argc!=2) && (argc!=3))
       {
@@ -56,16 +56,14 @@ int main(int argc, char **argv)
         lif_seek_phy_device(output_device,cylinder);
         for(head=0; head<2; head++)
           {
-            for(sector=1; sector<17; sector++)
+            if(fread(data,sizeof(char),PHY_SECTORS*SECTOR_SIZE,input_file)
+               !=PHY_SECTORS*SECTOR_SIZE)
               {
-                if(fread(data,sizeof(char),SECTOR_SIZE,input_file)
-                   !=SECTOR_SIZE)
-                  {
-                    fprintf(stderr,"Error reading input file\n");
-                    exit(1);
-                  }
-                lif_write_phy_device(output_device,cylinder,head,sector,data);
+                fprintf(stderr,"Error reading input file\n");
+                exit(1);
               }
+            /* write the whole track with one command */
+            lif_write_phy_device(output_device,cylinder,head,1,PHY_SECTORS,data);
           }
       }
     lif_close_phy_device(output_device);
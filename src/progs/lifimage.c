@@ -34,7 +34,7 @@ int main(int argc, char **argv)
     int head; 
     int sector;
     FILE *output_file;
-    unsigned char data[SECTOR_SIZE];
+    unsigned char data[PHY_SECTORS*SECTOR_SIZE];
 
     if((argc != 2) && (argc !=3))
       {
@@ -64,16 +64,27 @@ int main(int argc, char **argv)
          lif_seek_phy_device(input_device,cylinder);
          for(head=0; head<2; head++)
            {
-             for(sector=1; sector<17; sector++)
+             /* read the whole track with one command, if a sector is
+                unreadable read the sectors one by one to find it */
+             if(lif_read_phy_device(input_device,cylinder,head,1,PHY_SECTORS,data))
                {
-                 lif_read_phy_device(input_device,cylinder,head,sector,data);
-                 if(fwrite(data,sizeof(char),SECTOR_SIZE,output_file)
-                    !=SECTOR_SIZE)
+                 for(sector=1; sector<=PHY_SECTORS; sector++)
                    {
-                     fprintf(stderr,"Error writing output file\n");
-                     exit(1);
-                   } 
+                     if(lif_read_phy_device(input_device,cylinder,head,sector,1,
+                        data+(sector-1)*SECTOR_SIZE))
+                       {
+                         fprintf(stderr,"Error reading cylinder %d, head %d, sector %d\n",
+                                 cylinder,head,sector);
+                         exit(1);
+                       }
+                   }
                }
+             if(fwrite(data,sizeof(char),PHY_SECTORS*SECTOR_SIZE,output_file)
+                !=PHY_SECTORS*SECTOR_SIZE)
+               {
+                 fprintf(stderr,"Error writing output file\n");
+                 exit(1);
+               } 
            }
       }
     lif_close_phy_device(input_device);
@@ -10,6 +10,7 @@
 #include "version.h"
 #include "lifutils.h"
 #include "lif_dir_utils.h"
+#include "lif_stats.h"
 
 #define PROGNAME_LEN 15
 #define HELP_LEN 100
@@ -41,14 +42,19 @@ func functions[]= {
    { .f=&liflabel, .name= "liflabel",.help="label a LIF image file" },
    { .f=&lifmod, .name= "lifmod",.help="read contents and info of HP-41 module files" },
    { .f=&lifheader, .name= "lifheader",.help="show the header information of a LIF file" },
+   { .f=&lifjournal, .name= "lifjournal",.help="group modifications of a LIF image file into a transaction" },
    { .f=&lifpack, .name= "lifpack",.help="pack a LIF image file" },
    { .f=&lifpurge, .name= "lifpurge",.help="purge a file from a LIF image file" },
    { .f=&lifput, .name= "lifput",.help="put a LIF file into a LIF image file" },
    { .f=&lifraw, .name= "lifraw",.help="remove the LIF file header from a LIF file" },
+   { .f=&lifrec, .name= "lifrec",.help="read or write records of a data file in a LIF image file" },
    { .f=&lifrename, .name= "lifrename",.help="rename a file in  a LIF image file" },
+   { .f=&lifresize, .name= "lifresize",.help="grow or shrink the directory of a LIF image file" },
    { .f=&lifstat, .name= "lifstat",.help="display properties of a LIF image file" },
    { .f=&liftext, .name= "liftext",.help="translate a HP LIF text file into an ASCII text file" },
    { .f=&liftext75, .name= "liftext75",.help="translate a raw HP-75 text file into an ASCII text file" },
+   { .f=&liftrace, .name= "liftrace",.help="project the access time of a block trace on a HP 9114/9122 drive" },
+   { .f=&lifundel, .name= "lifundel",.help="list, restore or extract deleted files of LIF image files" },
    { .f=&outp41, .name= "outp41",.help="produce a HP41 hexadecimal program" },
    { .f=&out71, .name= "out71",.help="send a program to a HP-71B" },
    { .f=&prog41bar, .name= "prog41bar",.help="produce an intermediate barcode file from a HP-41 program raw file"},
@@ -149,7 +155,9 @@ void lifutils_usage(void)
    fprintf(stderr,"Usage: lifutils [-v] [-?]\n");
    fprintf(stderr,"       -v Output version string\n");
    fprintf(stderr,"or\n");
-   fprintf(stderr,"       lifutils <program> <parameters ...>\n\n");
+   fprintf(stderr,"       lifutils [--stats] [--trace FILE] <program> <parameters ...>\n");
+   fprintf(stderr,"       --stats Output block i/o statistics as JSON to standard error\n");
+   fprintf(stderr,"       --trace FILE Log all block accesses to FILE\n\n");
    fprintf(stderr,"Available programs are:\n\n");
    for(i=0;i<(int)(sizeof(functions)/sizeof(func));i++) {
       fprintf(stderr,"%15.15s %s\n",functions[i].name,functions[i].help);
@@ -159,7 +167,8 @@ void lifutils_usage(void)
 
 int main(int argc, char **argv)
 {
-   int i,ret;
+   int i,ret,stats;
+   char *trace;
    char progname[PROGNAME_LEN];
 
    /* no parameter */
@@ -177,6 +186,27 @@ int main(int argc, char **argv)
       lifutils_usage();
       exit(EXIT_OK);
    }
+   /* collect statistics or trace the block i/o, if requested */
+   stats=getenv("LIFUTILSSTATS") != (char *) NULL;
+   trace=getenv("LIFUTILSTRACE");
+   while(argc > 1 && strncmp(argv[1],"--",2)==0) {
+      if(strcmp(argv[1],"--stats")==0) {
+         stats=1;
+      } else if(strcmp(argv[1],"--trace")==0 && argc > 2) {
+         argc--;
+         argv++;
+         trace=argv[1];
+      } else {
+         lifutils_usage();
+         return(EXIT_ERROR);
+      }
+      argc--;
+      argv++;
+   }
+   if(argc==1) {
+      lifutils_usage();
+      return(EXIT_ERROR);
+   }
    if(strlen(argv[1])>PROGNAME_LEN) {
       lifutils_usage();
       exit(EXIT_ERROR);
@@ -188,6 +218,11 @@ int main(int argc, char **argv)
 
    for(i=0;i<(int) (sizeof(functions)/sizeof(func));i++) {
       if(strcmp(progname,functions[i].name)==0) {
+         if(stats) lif_stats_init(functions[i].name);
+         if(trace != (char *) NULL && lif_stats_trace(trace)) {
+            fprintf(stderr,"Cannot create trace file %s\n",trace);
+            exit(EXIT_ERROR);
+         }
          ret=functions[i].f(argc-1,&argv[1]);
          if(ret== RETURN_ERROR) {
             exit(EXIT_ERROR);
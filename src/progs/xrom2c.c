@@ -0,0 +1,117 @@
+/* xrom2c.c -- convert XROM files to C tables */
+/* 2026 J. Siebold, and placed under the GPL */
+
+/* This program is run at build time. It reads the XROM files given on the
+   command line and writes a C file with a constant table for each file
+   and the list xrom_tables[] of all tables (see xrom.h). The name of a
+   table is the file name without the directory and the extension .xrom.
+
+   The lines are parsed like read_xrom() does. The strings of the names
+   are output with octal escapes for all characters except letters and
+   digits, thus the C file is independent of the source character set
+   of the compiler. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static void put_string(FILE *out, char *str)
+  {
+    unsigned char c;
+
+    fputc('"',out);
+    while((c= (unsigned char) *str++) != '\0')
+      {
+        if(c < 0x80 && isalnum(c))
+          fputc(c,out);
+        else
+          fprintf(out,"\\%03o",c);
+      }
+    fputc('"',out);
+  }
+
+static void table_name(char *name, char *filename)
+  {
+    /* get the table name from the file name */
+    char *p, *ext;
+
+    p=strrchr(filename,'/');
+    if(p == (char *) NULL) p=strrchr(filename,'\\');
+    p= p == (char *) NULL ? filename : p+1;
+    strncpy(name,p,39);
+    name[39]='\0';
+    ext=strstr(name,".xrom");
+    if(ext != (char *) NULL) *ext='\0';
+  }
+
+int main(int argc, char **argv)
+  {
+    FILE *out, *xrom_file;
+    char line[100];
+    int rom, fn, len, i, count;
+    char this_name[40];
+    char alt_name[40];
+    char name[40];
+
+    if(argc < 2)
+      {
+        fprintf(stderr,"Usage: xrom2c OUTPUTFILE XROMFILE ...\n");
+        return(1);
+      }
+    if((out=fopen(argv[1],"w")) == (FILE *) NULL)
+      {
+        fprintf(stderr,"Error opening %s\n",argv[1]);
+        return(1);
+      }
+    fprintf(out,"/* generated by xrom2c from the XROM files, do not edit */\n\n");
+    fprintf(out,"#include <stdio.h>\n#include \"xrom.h\"\n\n");
+
+    for(i=2; i< argc; i++)
+      {
+        if((xrom_file=fopen(argv[i],"r")) == (FILE *) NULL)
+          {
+            fprintf(stderr,"Error opening %s\n",argv[i]);
+            fclose(out);
+            return(1);
+          }
+        fprintf(out,"static const struct xrom_entry xrom_table_%d[]=\n  {\n",i-2);
+        count=0;
+        while(fgets(line,80,xrom_file))
+          {
+            len=sscanf(line,"%d %d %39s %39s",&rom,&fn,this_name,alt_name);
+            if(len != 3 && len != 4) continue;
+            if(len == 3) alt_name[0]='\0';
+            fprintf(out,"    { %d, %d, ",rom,fn);
+            put_string(out,this_name);
+            fprintf(out,", ");
+            put_string(out,alt_name);
+            fprintf(out," },\n");
+            count++;
+          }
+        fclose(xrom_file);
+        fprintf(out,"    { 0, 0, NULL, NULL }\n  };\n\n");
+        if(count == 0)
+          {
+            fprintf(stderr,"No XROM entries in %s\n",argv[i]);
+            fclose(out);
+            return(1);
+          }
+      }
+
+    fprintf(out,"const struct xrom_table xrom_tables[]=\n  {\n");
+    for(i=2; i< argc; i++)
+      {
+        table_name(name,argv[i]);
+        fprintf(out,"    { ");
+        put_string(out,name);
+        fprintf(out,", xrom_table_%d },\n",i-2);
+      }
+    fprintf(out,"    { NULL, NULL }\n  };\n");
+    if(fclose(out) != 0)
+      {
+        fprintf(stderr,"Error writing %s\n",argv[1]);
+        return(1);
+      }
+    return(0);
+  }
@@ -49,6 +49,9 @@ lifutils lifdir liftest.dat > test.txt
 python ..\difftool.py test.txt ..\data\lifdir_liftest_filled.txt
 
 lifutils lifpurge liftest.dat VERMROM
+lifutils lifpack -d liftest.dat
+lifutils lifdir -f csv liftest.dat > test.txt
+python ..\difftool.py test.txt ..\data\lifdir_liftest_dirpacked.txt
 lifutils lifpack liftest.dat
 lifutils liflabel -c liftest.dat
 lifutils lifstat liftest.dat > test.txt
@@ -71,10 +74,98 @@ lifutils lifdir -v 2 liftest.dat > test.txt
 python ..\difftool.py test.txt ..\data\lifdir_liftest_packed_verbose.txt
 lifutils lifdir -c liftest.dat > test.txt
 python ..\difftool.py test.txt ..\data\lifdir_liftest_packed_csv.txt
+lifutils lifdir -f json -s name liftest.dat > test.txt
+python ..\difftool.py test.txt ..\data\lifdir_liftest_packed_json.txt
+lifutils lifdir -f csv -s size liftest.dat > test.txt
+python ..\difftool.py test.txt ..\data\lifdir_liftest_packed_fullcsv.txt
+lifutils lifresize liftest.dat 100
+lifutils lifdir -f csv liftest.dat > test.txt
+python ..\difftool.py test.txt ..\data\lifdir_liftest_resized.txt
+copy liftest.dat jnl.dat > nul
+lifutils lifjournal -b jnl.dat
+lifutils lifpurge jnl.dat TXTB
+lifutils lifrename jnl.dat TXT75 TXT75A
+lifutils lifpack jnl.dat
+python ..\difftool.py --binary jnl.dat liftest.dat
+lifutils lifdir -f csv jnl.dat > test.txt
+python ..\difftool.py test.txt ..\data\lifdir_liftest_resized.txt
+lifutils lifput mem:jnl.dat ..\data\wall1.lif 2> test.txt
+python ..\difftool.py test.txt ..\data\lifput_journal_mem.txt
+lifutils lifjournal -c jnl.dat
+lifutils lifdir -f csv jnl.dat > test.txt
+python ..\difftool.py test.txt ..\data\lifdir_liftest_journal.txt
+copy liftest.dat rec.dat > nul
+lifutils lifjournal -b rec.dat
+lifutils lifpurge rec.dat TXTB
+lifutils lifrename rec.dat TXT75 TXT75A
+lifutils lifpack rec.dat
+lifutils lifjournal -n rec.dat
+lifutils lifjournal rec.dat
+copy rec.dat.journal rec.journal > nul
+lifutils lifjournal -r rec.dat 2> nul
+copy rec.journal rec.dat.journal > nul
+lifutils lifjournal -r rec.dat 2> nul
+python ..\difftool.py --binary rec.dat jnl.dat
+lifutils lifjournal rec.dat
+copy liftest.dat abt.dat > nul
+lifutils lifjournal -b abt.dat
+lifutils lifpurge abt.dat TXTB
+lifutils textlif TXTC < ..\data\prog41.txt | lifutils lifput abt.dat
+lifutils lifjournal -a abt.dat
+python ..\difftool.py --binary abt.dat liftest.dat
+lifutils lifjournal abt.dat
+copy liftest.dat prg.dat > nul
+lifutils lifpurge prg.dat TXTB
+copy liftest.dat trn.dat > nul
+lifutils lifjournal -b trn.dat
+lifutils lifpurge trn.dat TXTB
+lifutils lifrename trn.dat TXT75 TXT75A
+lifutils lifjournal trn.dat
+python -c "import os; os.truncate('trn.dat.journal',os.path.getsize('trn.dat.journal')-100)"
+lifutils lifjournal trn.dat
+lifutils lifjournal -c trn.dat
+python ..\difftool.py --binary trn.dat prg.dat
+copy liftest.dat mem.dat > nul
+lifutils lifpurge mem:mem.dat TXTB
+lifutils lifrename mem:mem.dat TXT75 TXT75A
+lifutils lifpack mem:mem.dat
+python ..\difftool.py --binary mem.dat jnl.dat
+lifutils lifpurge - TXTB < liftest.dat | lifutils lifrename - TXT75 TXT75A | lifutils lifpack - > stream.dat
+python ..\difftool.py --binary stream.dat jnl.dat
+lifutils lifdir -f csv - < jnl.dat > test.txt
+python ..\difftool.py test.txt ..\data\lifdir_liftest_journal.txt
+lifutils --stats lifget jnl.dat TXT75A 2> test.txt > nul
+python ..\difftool.py test.txt ..\data\lifget_stats.txt
+copy liftest.dat trc.dat > nul
+lifutils --trace trace.txt lifpack trc.dat
+lifutils liftrace trace.txt > test.txt
+python ..\difftool.py test.txt ..\data\liftrace_lifpack.txt
+copy liftest.dat sim.dat > nul
+lifutils lifpurge sim:sim.dat TXTB
+lifutils lifrename sim:sim.dat TXT75 TXT75A
+lifutils --stats lifpack sim:sim.dat 2> test.txt
+python ..\difftool.py test.txt ..\data\lifpack_sim.txt
+lifutils lifdir -f csv sim:sim.dat > test.txt
+python ..\difftool.py test.txt ..\data\lifdir_liftest_journal.txt
 
 lifutils lifget  liftest.dat TXTA  | lifutils lifraw | lifutils liftext > test.txt
 python ..\difftool.py  test.txt ..\data\txta.txt
 
+lifutils textlif TXTA < ..\data\prog41.txt | lifutils lifput -r liftest.dat
+lifutils lifget liftest.dat TXTA | lifutils lifraw | lifutils liftext > test.txt
+python ..\difftool.py  test.txt ..\data\prog41.txt
+lifutils lifinit -m cass full.dat 16
+python -c "print(('X'*254+'\n')*504,end='')" | lifutils textlif BIG | lifutils lifput full.dat
+lifutils textlif TXTA < ..\data\prog41.txt | lifutils lifput full.dat
+lifutils textlif TXTA < ..\data\txta.txt | lifutils lifput -r full.dat
+lifutils lifget full.dat TXTA | lifutils lifraw | lifutils liftext > test.txt
+python ..\difftool.py  test.txt ..\data\txta.txt
+lifutils textlif TXTA < ..\data\lifput_replace.txt | lifutils lifput -r full.dat
+lifutils lifget full.dat TXTA | lifutils lifraw | lifutils liftext > test.txt
+python ..\difftool.py  test.txt ..\data\lifput_replace.txt
+lifutils lifdir -f csv full.dat > test.txt
+python ..\difftool.py  test.txt ..\data\lifdir_lifput_full.txt
+
 lifutils lifget  liftest.dat TXT75  | lifutils lifraw | lifutils liftext75  > test.txt
 python ..\difftool.py  test.txt ..\data\txta.txt
 
@@ -87,12 +178,57 @@ python ..\difftool.py  test.txt ..\data\txta75.txt
 lifutils lifget -r liftest.dat TEST1 |  lifutils decomp41 -x hpil -x hepax > test.txt
 python ..\difftool.py  test.txt ..\data\prog41.txt
 
+set XROMDIR=%LIFUTILSXROMDIR%
+set LIFUTILSXROMDIR=.
+lifutils lifget -r liftest.dat TEST1 |  lifutils decomp41 -x hpil -x hepax > test.txt
+set LIFUTILSXROMDIR=%XROMDIR%
+python ..\difftool.py  test.txt ..\data\prog41.txt
+
+lifutils lifinit -m cass comp.dat 60
+lifutils comp41 -x hpil -x hepax -o comp.dat ..\data\prog41.txt ..\data\audi2.txt
+lifutils lifget -r comp.dat PROG41 |  lifutils decomp41 -x hpil -x hepax > test.txt
+python ..\difftool.py  test.txt ..\data\prog41.txt
+
+lifutils comp41 -O ..\data\opt41.txt 2> test.txt > opt41.raw
+python ..\difftool.py  test.txt ..\data\opt41_report.txt
+lifutils decomp41 < opt41.raw > test.txt
+python ..\difftool.py  test.txt ..\data\opt41_decomp.txt
+
+lifutils comp41 ..\data\jump41.txt > test.raw
+python ..\difftool.py --binary test.raw ..\data\jump41.raw
+lifutils raw41lif JUMP41 < ..\data\jump41_kept.raw | lifutils lifraw > test.raw
+python ..\difftool.py --binary test.raw ..\data\jump41_kept_lif.raw
+
+mkdir c41cache
+lifutils comp41 -c c41cache -x hpil -x hepax ..\data\prog41.txt > test.raw
+dir /B c41cache | find /C ".c41"
+lifutils comp41 -c c41cache -x hpil -x hepax ..\data\prog41.txt | lifutils decomp41 -x hpil -x hepax > test.txt
+python ..\difftool.py  test.txt ..\data\prog41.txt
+lifutils comp41 -c c41cache -P 0
+
 lifutils lifget -r liftest.dat DAT1 | lifutils sdata > test.txt
 python ..\difftool.py  test.txt ..\data\dat1.txt
 lifutils lifget -r liftest.dat DAT1 | lifutils sdata -h > test.txt
 python ..\difftool.py  test.txt ..\data\dat1_hex.txt
 lifutils lifget -r liftest.dat DAT1 | lifutils sdata -n -b -l > test.txt
 python ..\difftool.py  test.txt ..\data\dat1_extended.txt
+lifutils lifrec -c 20 liftest.dat DAT1 0 | lifutils sdata > test.txt
+python ..\difftool.py  test.txt ..\data\dat1.txt
+lifutils lifrec liftest.dat DAT1 0 > rec0.raw
+lifutils lifrec liftest.dat DAT1 19 > rec19.raw
+lifutils lifrec -w liftest.dat DAT1 19 < rec0.raw
+lifutils lifrec -c 2 liftest.dat DAT1 18 | lifutils sdata > test.txt
+python ..\difftool.py  test.txt ..\data\dat1_rec.txt
+lifutils lifrec -w liftest.dat DAT1 19 < rec19.raw
+copy liftest.dat sec.dat > nul
+python -c "d=bytearray(open('sec.dat','rb').read()); i=d.index(b'DAT1      '); d[i+10:i+12]=b'\xe0\xf1'; d[i+28:i+32]=b'\x14\x00\x08\x00'; open('sec.dat','wb').write(d)"
+lifutils lifrec -w sec.dat DAT1 19 < rec0.raw 2> test.txt
+python ..\difftool.py  test.txt ..\data\lifrec_secured.txt
+lifutils lifrec sec.dat DAT1 19 > test.raw
+python ..\difftool.py --binary test.raw rec19.raw
+lifutils lifrec -w -f sec.dat DAT1 19 < rec0.raw
+lifutils lifrec sec.dat DAT1 19 > test.raw
+python ..\difftool.py --binary test.raw rec0.raw
 
 lifutils lifget -r liftest.dat DAT1 | lifutils regs41 > test.txt
 python ..\difftool.py  test.txt ..\data\regs1.txt
@@ -125,6 +261,14 @@ python ..\difftool.py  test.txt ..\data\barprt.txt
 
 lifutils lifget -r liftest.dat MEM | lifutils lexcat71 > test.txt
 python ..\difftool.py  test.txt ..\data\lexcat71.txt
+copy ..\data\undel.dat undel.dat > nul
+lifutils lifundel -c undel.dat > test.txt
+python ..\difftool.py  test.txt ..\data\lifundel_scan.txt
+lifutils lifundel -x c2 undel.dat | lifutils lexcat71 > test.txt
+python ..\difftool.py  test.txt ..\data\lexcat71.txt
+lifutils lifundel -r 1 undel.dat
+lifutils lifget -r undel.dat TEST1 | lifutils decomp41 -x hpil -x hepax > test.txt
+python ..\difftool.py  test.txt ..\data\prog41.txt
 
 lifutils lifget -r liftest.dat PHYCONS | lifutils lexcat75 > test.txt
 python ..\difftool.py  test.txt ..\data\lexcat75.txt
@@ -171,3 +315,23 @@ if exist tst.txt del /F tst.txt
 if exist prog.000 del /F prog.000
 if exist prog.001 del /F prog.001
 if exist prog.002 del /F prog.002
+if exist rec0.raw del /F rec0.raw
+if exist rec19.raw del /F rec19.raw
+if exist sec.dat del /F sec.dat
+if exist undel.dat del /F undel.dat
+if exist jnl.dat del /F jnl.dat
+if exist full.dat del /F full.dat
+if exist rec.dat del /F rec.dat
+if exist rec.journal del /F rec.journal
+if exist abt.dat del /F abt.dat
+if exist prg.dat del /F prg.dat
+if exist trn.dat del /F trn.dat
+if exist mem.dat del /F mem.dat
+if exist stream.dat del /F stream.dat
+if exist trc.dat del /F trc.dat
+if exist trace.txt del /F trace.txt
+if exist sim.dat del /F sim.dat
+if exist comp.dat del /F comp.dat
+if exist opt41.raw del /F opt41.raw
+if exist test.raw del /F test.raw
+if exist c41cache rmdir /S /Q c41cache
@@ -46,6 +46,9 @@ lifutils lifdir liftest.dat > test.txt
 python3 ../difftool.py test.txt ../data/lifdir_liftest_filled.txt
 
 lifutils lifpurge liftest.dat VERMROM
+lifutils lifpack -d liftest.dat
+lifutils lifdir -f csv liftest.dat > test.txt
+python3 ../difftool.py test.txt ../data/lifdir_liftest_dirpacked.txt
 lifutils lifpack liftest.dat
 lifutils liflabel -c liftest.dat
 lifutils lifstat liftest.dat > test.txt
@@ -68,10 +71,107 @@ lifutils lifdir -v 2 liftest.dat > test.txt
 python3 ../difftool.py test.txt ../data/lifdir_liftest_packed_verbose.txt
 lifutils lifdir -c liftest.dat > test.txt
 python3 ../difftool.py test.txt ../data/lifdir_liftest_packed_csv.txt
+lifutils lifdir -f json -s name liftest.dat > test.txt
+python3 ../difftool.py test.txt ../data/lifdir_liftest_packed_json.txt
+lifutils lifdir -f csv -s size liftest.dat > test.txt
+python3 ../difftool.py test.txt ../data/lifdir_liftest_packed_fullcsv.txt
+lifutils lifresize liftest.dat 100
+lifutils lifdir -f csv liftest.dat > test.txt
+python3 ../difftool.py test.txt ../data/lifdir_liftest_resized.txt
+cp liftest.dat jnl.dat
+lifutils lifjournal -b jnl.dat
+lifutils lifpurge jnl.dat TXTB
+lifutils lifrename jnl.dat TXT75 TXT75A
+lifutils lifpack jnl.dat
+python3 ../difftool.py --binary jnl.dat liftest.dat
+lifutils lifdir -f csv jnl.dat > test.txt
+python3 ../difftool.py test.txt ../data/lifdir_liftest_resized.txt
+lifutils lifput mem:jnl.dat ../data/wall1.lif 2> test.txt
+python3 ../difftool.py test.txt ../data/lifput_journal_mem.txt
+lifutils lifjournal -c jnl.dat
+lifutils lifdir -f csv jnl.dat > test.txt
+python3 ../difftool.py test.txt ../data/lifdir_liftest_journal.txt
+cp liftest.dat rec.dat
+lifutils lifjournal -b rec.dat
+lifutils lifpurge rec.dat TXTB
+lifutils lifrename rec.dat TXT75 TXT75A
+lifutils lifpack rec.dat
+lifutils lifjournal -n rec.dat
+lifutils lifjournal rec.dat
+cp rec.dat.journal rec.journal
+lifutils lifjournal -r rec.dat 2> /dev/null
+cp rec.journal rec.dat.journal
+lifutils lifjournal -r rec.dat 2> /dev/null
+python3 ../difftool.py --binary rec.dat jnl.dat
+lifutils lifjournal rec.dat
+cp liftest.dat abt.dat
+lifutils lifjournal -b abt.dat
+lifutils lifpurge abt.dat TXTB
+lifutils textlif TXTC < ../data/prog41.txt | lifutils lifput abt.dat
+lifutils lifjournal -a abt.dat
+python3 ../difftool.py --binary abt.dat liftest.dat
+lifutils lifjournal abt.dat
+cp liftest.dat prg.dat
+lifutils lifpurge prg.dat TXTB
+cp liftest.dat trn.dat
+lifutils lifjournal -b trn.dat
+lifutils lifpurge trn.dat TXTB
+lifutils lifrename trn.dat TXT75 TXT75A
+lifutils lifjournal trn.dat
+python3 -c "import os; os.truncate('trn.dat.journal',os.path.getsize('trn.dat.journal')-100)"
+lifutils lifjournal trn.dat
+lifutils lifjournal -c trn.dat
+python3 ../difftool.py --binary trn.dat prg.dat
+cp liftest.dat mem.dat
+lifutils lifpurge mem:mem.dat TXTB
+lifutils lifrename mem:mem.dat TXT75 TXT75A
+lifutils lifpack mem:mem.dat
+python3 ../difftool.py --binary mem.dat jnl.dat
+lifutils lifpurge - TXTB < liftest.dat | lifutils lifrename - TXT75 TXT75A | lifutils lifpack - > stream.dat
+python3 ../difftool.py --binary stream.dat jnl.dat
+lifutils lifdir -f csv - < jnl.dat > test.txt
+python3 ../difftool.py test.txt ../data/lifdir_liftest_journal.txt
+lifutils --stats lifget jnl.dat TXT75A 2> test.txt > /dev/null
+python3 ../difftool.py test.txt ../data/lifget_stats.txt
+cp liftest.dat trc.dat
+lifutils --trace trace.txt lifpack trc.dat
+lifutils liftrace trace.txt > test.txt
+python3 ../difftool.py test.txt ../data/liftrace_lifpack.txt
+cp liftest.dat sim.dat
+lifutils lifpurge sim:sim.dat TXTB
+lifutils lifrename sim:sim.dat TXT75 TXT75A
+lifutils --stats lifpack sim:sim.dat 2> test.txt
+python3 ../difftool.py test.txt ../data/lifpack_sim.txt
+lifutils lifdir -f csv sim:sim.dat > test.txt
+python3 ../difftool.py test.txt ../data/lifdir_liftest_journal.txt
+lifutils lifinit -m cass wch.dat 16
+lifutils textlif TXTB < ../data/prog41.txt | lifutils lifput wch.dat
+timeout 3 lifutils lifdir -w -f csv file:wch.dat > watch.txt &
+sleep 1
+lifutils textlif TXTW < ../data/prog41.txt | lifutils lifput wch.dat
+sleep 1
+lifutils lifpurge wch.dat TXTB
+wait
+python3 ../difftool.py watch.txt ../data/lifdir_watch.txt
 
 lifutils lifget liftest.dat TXTA | lifutils lifraw | lifutils liftext > test.txt
 python3 ../difftool.py  test.txt ../data/txta.txt
 
+lifutils textlif TXTA < ../data/prog41.txt | lifutils lifput -r liftest.dat
+lifutils lifget liftest.dat TXTA | lifutils lifraw | lifutils liftext > test.txt
+python3 ../difftool.py  test.txt ../data/prog41.txt
+lifutils lifinit -m cass full.dat 16
+python3 -c "print(('X'*254+'\n')*504,end='')" | lifutils textlif BIG | lifutils lifput full.dat
+lifutils textlif TXTA < ../data/prog41.txt | lifutils lifput full.dat
+lifutils textlif TXTA < ../data/txta.txt | lifutils lifput -r full.dat
+lifutils lifget full.dat TXTA | lifutils lifraw | lifutils liftext > test.txt
+python3 ../difftool.py  test.txt ../data/txta.txt
+lifutils textlif TXTA < ../data/lifput_replace.txt | lifutils lifput -r full.dat
+lifutils lifget full.dat TXTA | lifutils lifraw | lifutils liftext > test.txt
+python3 ../difftool.py  test.txt ../data/lifput_replace.txt
+lifutils lifdir -f csv full.dat > test.txt
+python3 ../difftool.py  test.txt ../data/lifdir_lifput_full.txt
+
 lifutils lifget liftest.dat TXT75  | lifutils lifraw | lifutils liftext75  > test.txt
 python3 ../difftool.py  test.txt ../data/txta.txt
 
@@ -83,12 +183,54 @@ python3 ../difftool.py  test.txt ../data/txta75.txt
 lifutils lifget -r liftest.dat TEST1 |  lifutils decomp41 -x hpil -x hepax > test.txt
 python3 ../difftool.py  test.txt ../data/prog41.txt
 
+lifutils lifget -r liftest.dat TEST1 |  LIFUTILSXROMDIR=. lifutils decomp41 -x hpil -x hepax > test.txt
+python3 ../difftool.py  test.txt ../data/prog41.txt
+
+lifutils lifinit -m cass comp.dat 60
+lifutils comp41 -x hpil -x hepax -o comp.dat ../data/prog41.txt ../data/audi2.txt
+lifutils lifget -r comp.dat PROG41 |  lifutils decomp41 -x hpil -x hepax > test.txt
+python3 ../difftool.py  test.txt ../data/prog41.txt
+
+lifutils comp41 -O ../data/opt41.txt 2> test.txt > opt41.raw
+python3 ../difftool.py  test.txt ../data/opt41_report.txt
+lifutils decomp41 < opt41.raw > test.txt
+python3 ../difftool.py  test.txt ../data/opt41_decomp.txt
+
+lifutils comp41 ../data/jump41.txt > test.raw
+python3 ../difftool.py --binary test.raw ../data/jump41.raw
+lifutils raw41lif JUMP41 < ../data/jump41_kept.raw | lifutils lifraw > test.raw
+python3 ../difftool.py --binary test.raw ../data/jump41_kept_lif.raw
+
+mkdir c41cache
+lifutils comp41 -c c41cache -x hpil -x hepax ../data/prog41.txt > test.raw
+ls c41cache | grep -c '\.c41$'
+lifutils comp41 -c c41cache -x hpil -x hepax ../data/prog41.txt | lifutils decomp41 -x hpil -x hepax > test.txt
+python3 ../difftool.py  test.txt ../data/prog41.txt
+lifutils comp41 -c c41cache -P 0
+
 lifutils lifget -r liftest.dat DAT1 | lifutils sdata > test.txt
 python3 ../difftool.py  test.txt ../data/dat1.txt
 lifutils lifget -r liftest.dat DAT1 | lifutils sdata -h > test.txt
 python3 ../difftool.py  test.txt ../data/dat1_hex.txt
 lifutils lifget -r liftest.dat DAT1 | lifutils sdata -n -b -l > test.txt
 python3 ../difftool.py  test.txt ../data/dat1_extended.txt
+lifutils lifrec -c 20 liftest.dat DAT1 0 | lifutils sdata > test.txt
+python3 ../difftool.py  test.txt ../data/dat1.txt
+lifutils lifrec liftest.dat DAT1 0 > rec0.raw
+lifutils lifrec liftest.dat DAT1 19 > rec19.raw
+lifutils lifrec -w liftest.dat DAT1 19 < rec0.raw
+lifutils lifrec -c 2 liftest.dat DAT1 18 | lifutils sdata > test.txt
+python3 ../difftool.py  test.txt ../data/dat1_rec.txt
+lifutils lifrec -w liftest.dat DAT1 19 < rec19.raw
+cp liftest.dat sec.dat
+python3 -c "d=bytearray(open('sec.dat','rb').read()); i=d.index(b'DAT1      '); d[i+10:i+12]=b'\xe0\xf1'; d[i+28:i+32]=b'\x14\x00\x08\x00'; open('sec.dat','wb').write(d)"
+lifutils lifrec -w sec.dat DAT1 19 < rec0.raw 2> test.txt
+python3 ../difftool.py  test.txt ../data/lifrec_secured.txt
+lifutils lifrec sec.dat DAT1 19 > test.raw
+python3 ../difftool.py --binary test.raw rec19.raw
+lifutils lifrec -w -f sec.dat DAT1 19 < rec0.raw
+lifutils lifrec sec.dat DAT1 19 > test.raw
+python3 ../difftool.py --binary test.raw rec0.raw
 
 lifutils lifget -r liftest.dat DAT1 | lifutils regs41 > test.txt
 python3 ../difftool.py  test.txt ../data/regs1.txt
@@ -120,6 +262,14 @@ python3 ../difftool.py  test.txt ../data/barprt.txt
 
 lifutils lifget -r liftest.dat MEM | lifutils lexcat71 > test.txt
 python3 ../difftool.py  test.txt ../data/lexcat71.txt
+cp ../data/undel.dat undel.dat
+lifutils lifundel -c undel.dat > test.txt
+python3 ../difftool.py  test.txt ../data/lifundel_scan.txt
+lifutils lifundel -x c2 undel.dat | lifutils lexcat71 > test.txt
+python3 ../difftool.py  test.txt ../data/lexcat71.txt
+lifutils lifundel -r 1 undel.dat
+lifutils lifget -r undel.dat TEST1 | lifutils decomp41 -x hpil -x hepax > test.txt
+python3 ../difftool.py  test.txt ../data/prog41.txt
 
 lifutils lifget -r liftest.dat PHYCONS | lifutils lexcat75 > test.txt
 python3 ../difftool.py  test.txt ../data/lexcat75.txt
@@ -162,3 +312,25 @@ rm -f test.txt
 rm -f prog.000
 rm -f prog.001
 rm -f prog.002
+rm -f rec0.raw
+rm -f rec19.raw
+rm -f sec.dat
+rm -f undel.dat
+rm -f jnl.dat
+rm -f full.dat
+rm -f rec.dat
+rm -f rec.journal
+rm -f abt.dat
+rm -f prg.dat
+rm -f trn.dat
+rm -f mem.dat
+rm -f stream.dat
+rm -f trc.dat
+rm -f trace.txt
+rm -f sim.dat
+rm -f wch.dat
+rm -f watch.txt
+rm -f comp.dat
+rm -f opt41.raw
+rm -f test.raw
+rm -rf c41cache